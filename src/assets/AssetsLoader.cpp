@@ -11,8 +11,8 @@
 #include "../content/Content.h"
 #include "../logic/scripting/scripting.h"
 
-AssetsLoader::AssetsLoader(Assets* assets, const ResPaths* paths) 
-	: assets(assets), paths(paths) {
+AssetsLoader::AssetsLoader(Assets* assets, const ResPaths* paths, fs::path cacheFolder) 
+	: assets(assets), paths(paths), cacheFolder(cacheFolder) {
 	addLoader(ASSET_SHADER, assetload::shader);
 	addLoader(ASSET_TEXTURE, assetload::texture);
 	addLoader(ASSET_FONT, assetload::font);
@@ -92,3 +92,7 @@ void AssetsLoader::addDefaults(AssetsLoader& loader, const Content* content) {
 const ResPaths* AssetsLoader::getPaths() const {
 	return paths;
 }
+
+const fs::path& AssetsLoader::getCacheFolder() const {
+	return cacheFolder;
+}
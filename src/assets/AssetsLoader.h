@@ -6,6 +6,9 @@
 #include <functional>
 #include <map>
 #include <queue>
+#include <filesystem>
+
+namespace fs = std::filesystem;
 
 const short ASSET_TEXTURE = 1;
 const short ASSET_SHADER = 2;
@@ -32,8 +35,11 @@ class AssetsLoader {
 	std::map<int, aloader_func> loaders;
 	std::queue<aloader_entry> entries;
 	const ResPaths* paths;
+	fs::path cacheFolder;
 public:
-	AssetsLoader(Assets* assets, const ResPaths* paths);
+	/* @param cacheFolder folder to keep atlas layouts in (empty - no cache) */
+	AssetsLoader(Assets* assets, const ResPaths* paths, 
+				 fs::path cacheFolder=fs::path());
 	void addLoader(int tag, aloader_func func);
 	void add(
         int tag, 
@@ -49,6 +55,7 @@ public:
 	static void addDefaults(AssetsLoader& loader, const Content* content);
 
 	const ResPaths* getPaths() const;
+	const fs::path& getCacheFolder() const;
 };
 
 #endif // ASSETS_ASSETS_LOADER_H
@@ -86,7 +86,7 @@ static bool appendAtlas(AtlasBuilder& atlas, const fs::path& file) {
 }
 
 bool assetload::atlas(
-    AssetsLoader&,
+    AssetsLoader& loader,
     Assets* assets, 
     const ResPaths* paths,
     const std::string directory, 
@@ -97,7 +97,11 @@ bool assetload::atlas(
     for (const auto& file : paths->listdir(directory)) {
         if (!appendAtlas(builder, file)) continue;
     }
-    Atlas* atlas = builder.build(2);
+    fs::path cacheFile;
+    if (!loader.getCacheFolder().empty()) {
+        cacheFile = loader.getCacheFolder()/fs::path("atlas-"+name+".json");
+    }
+    Atlas* atlas = builder.build(2, 8192, cacheFile);
     assets->store(atlas, name);
     for (const auto& file : builder.getNames()) {
         assetload::animation(assets, paths, "textures", file, atlas);
@@ -22,6 +22,10 @@ const int ITEM_ICON_SIZE = 48;
 /* Chunk volume (count of voxels per Chunk) */
 constexpr int CHUNK_VOL = (CHUNK_W * CHUNK_H * CHUNK_D);
 
+/* Height of chunk section (chunk meshes are built per section) */
+const int CHUNK_SECTION_H = 16;
+constexpr int CHUNK_SECTIONS = CHUNK_H / CHUNK_SECTION_H;
+
 /* BLOCK_VOID is block id used to mark non-existing voxel (voxel of missing chunk) */
 const blockid_t BLOCK_VOID = std::numeric_limits<blockid_t>::max();
 const itemid_t ITEM_VOID = std::numeric_limits<itemid_t>::max();
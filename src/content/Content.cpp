@@ -6,6 +6,7 @@
 
 #include "../voxels/Block.h"
 #include "../items/ItemDef.h"
+#include "../util/hashutil.h"
 
 #include "ContentPack.h"
 #include "../logic/scripting/scripting.h"
@@ -129,6 +130,13 @@ ContentIndices::ContentIndices(
     std::vector<ItemDef*> itemDefs)
     : blockDefs(blockDefs), 
       itemDefs(itemDefs) {
+    uint64_t hash = util::FNV1A_BASIS;
+    for (Block* def : blockDefs) {
+        hash = util::hash_fnv1a(hash, def->name);
+        hash = util::hash_fnv1a(hash, &def->rt.emissive, sizeof(def->rt.emissive));
+        hash = util::hash_fnv1a(hash, &def->skyLightPassing, sizeof(def->skyLightPassing));
+    }
+    layersStamp = hash;
 }
 
 Content::Content(ContentIndices* indices, 
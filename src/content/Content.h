@@ -69,10 +69,18 @@ public:
 class ContentIndices {
     std::vector<Block*> blockDefs;
     std::vector<ItemDef*> itemDefs;
+    uint64_t layersStamp;
 public:
     ContentIndices(std::vector<Block*> blockDefs,
                    std::vector<ItemDef*> itemDefs);
 
+    /* Hash of blocks names and properties the stored chunk layers
+       (heightmap, emitters index) are derived from. Layer stored with other
+       stamp is outdated and must be rebuilt */
+    inline uint64_t getLayersStamp() const {
+        return layersStamp;
+    }
+
     inline Block* getBlockDef(blockid_t id) const {
         if (id >= blockDefs.size())
             return nullptr;
@@ -0,0 +1,185 @@
+#include "animation_bench.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "../typedefs.h"
+#include "../data/dynamic.h"
+#include "../files/files.h"
+#include "../graphics/Texture.h"
+#include "../graphics/TextureAnimation.h"
+#include "../util/timeutil.h"
+
+using namespace devtools;
+
+namespace {
+	const int BENCH_ANIMATIONS = 1000;
+	const int BENCH_FRAMES = 4;
+	const int BENCH_TEXTURES = 4;
+	const int BENCH_STEPS = 600;
+	const int PAUSED_STEPS = 100;
+	const float FRAME_DELTA = 1.0f / 60.0f;
+
+	/* Failed checks, first failures are printed */
+	struct Failures {
+		uint count = 0;
+
+		void check(bool condition, const char* name, int step) {
+			if (condition)
+				return;
+			if (count < 8) {
+				std::cerr << "  " << name << " failed at " << step << std::endl;
+			}
+			count++;
+		}
+	};
+
+	/* Texture destructor deletes GL texture and there is no GL context,
+	   so bench textures (only ids are used) are never deleted */
+	std::vector<Texture*> create_textures() {
+		std::vector<Texture*> textures;
+		for (int i = 0; i < BENCH_TEXTURES; i++) {
+			textures.push_back(new Texture(i + 1, 256, 256));
+		}
+		return textures;
+	}
+
+	TextureAnimation create_animation(Texture* src, Texture* dst,
+									  const std::vector<float>& durations) {
+		TextureAnimation animation(src, dst);
+		for (size_t i = 0; i < durations.size(); i++) {
+			Frame frame;
+			frame.srcPos = glm::ivec2(i * 16, 0);
+			frame.dstPos = glm::ivec2(0, 0);
+			frame.size = glm::ivec2(16, 16);
+			frame.duration = durations[i];
+			animation.addFrame(frame);
+		}
+		return animation;
+	}
+
+	/* Blits must be exactly the frames changed by the step */
+	void check_step(Failures& failures, int step,
+					const std::vector<TextureAnimation>& animations,
+					const std::vector<size_t>& prevFrames,
+					const std::vector<FrameBlit>& blits) {
+		std::vector<const Frame*> expected;
+		for (size_t i = 0; i < animations.size(); i++) {
+			const auto& animation = animations[i];
+			if (animation.currentFrame != prevFrames[i]) {
+				expected.push_back(&animation.frames[animation.currentFrame]);
+			}
+		}
+		std::vector<const Frame*> scheduled;
+		for (const auto& blit : blits) {
+			scheduled.push_back(blit.frame);
+		}
+		std::sort(expected.begin(), expected.end());
+		std::sort(scheduled.begin(), scheduled.end());
+		failures.check(expected == scheduled, "changed frames blits", step);
+	}
+
+	/* Animations of a few durations are advanced by display frames,
+	   then paused (zero delta)
+	   @param idleSteps steps with no frame changed
+	   @param blitsCount total blits scheduled
+	   @return scheduling time of all steps, microseconds */
+	int64_t check_schedule(Failures& failures, const std::vector<Texture*>& textures,
+						   int& idleSteps, size_t& blitsCount) {
+		std::vector<TextureAnimation> animations;
+		for (int i = 0; i < BENCH_ANIMATIONS; i++) {
+			float duration = DEFAULT_FRAME_DURATION * (1 + i % 3);
+			animations.push_back(create_animation(
+				textures[i % BENCH_TEXTURES],
+				textures[(i / BENCH_TEXTURES) % BENCH_TEXTURES],
+				std::vector<float>(BENCH_FRAMES, duration)
+			));
+		}
+		std::vector<FrameBlit> blits;
+		std::vector<size_t> prevFrames (animations.size());
+		idleSteps = 0;
+		blitsCount = 0;
+		int64_t time = 0;
+		for (int step = 0; step < BENCH_STEPS + PAUSED_STEPS; step++) {
+			bool paused = step >= BENCH_STEPS;
+			for (size_t i = 0; i < animations.size(); i++) {
+				prevFrames[i] = animations[i].currentFrame;
+			}
+			timeutil::Timer timer;
+			TextureAnimator::schedule(animations, paused ? 0.0f : FRAME_DELTA, blits);
+			time += timer.stop();
+
+			check_step(failures, step, animations, prevFrames, blits);
+			if (paused) {
+				failures.check(blits.empty(), "paused", step);
+			}
+			if (blits.empty()) {
+				idleSteps++;
+			}
+			blitsCount += blits.size();
+		}
+		// frames are changed every few display frames only
+		failures.check(idleSteps > PAUSED_STEPS, "idle steps", BENCH_STEPS);
+		failures.check(blitsCount > 0, "frames changed", BENCH_STEPS);
+		return time;
+	}
+
+	void check_zero_duration(Failures& failures, const std::vector<Texture*>& textures) {
+		Texture* src = textures[0];
+		Texture* dst = textures[1];
+
+		auto skipped = create_animation(src, dst, {0.1f, 0.0f, 0.1f});
+		failures.check(skipped.advance(0.1f) && skipped.currentFrame == 2,
+					   "zero duration frame skip", 0);
+
+		auto first = create_animation(src, dst, {0.0f, 0.1f});
+		failures.check(first.advance(0.0f) && first.currentFrame == 1,
+					   "zero duration first frame", 0);
+		failures.check(!first.advance(0.05f) && first.currentFrame == 1,
+					   "frame after zero duration", 0);
+
+		std::vector<TextureAnimation> stopped {
+			create_animation(src, dst, {0.0f, 0.0f, 0.0f})
+		};
+		std::vector<FrameBlit> blits;
+		for (int step = 0; step < BENCH_FRAMES; step++) {
+			TextureAnimator::schedule(stopped, FRAME_DELTA, blits);
+			failures.check(blits.empty() && stopped[0].currentFrame == 0,
+						   "zero duration frames only", step);
+		}
+	}
+}
+
+bool devtools::run_animation_bench(fs::path file) {
+	std::cout << "-- texture animation check" << std::endl;
+	auto textures = create_textures();
+	Failures schedule;
+	int idleSteps;
+	size_t blitsCount;
+	int64_t time = check_schedule(schedule, textures, idleSteps, blitsCount);
+	Failures zeroDuration;
+	check_zero_duration(zeroDuration, textures);
+	bool passed = schedule.count == 0 && zeroDuration.count == 0;
+	double stepTime = double(time) / (BENCH_STEPS + PAUSED_STEPS);
+
+	std::cout << "  schedule: " << schedule.count << " failed, zero duration: "
+			  << zeroDuration.count << " failed" << std::endl;
+	std::cout << "  " << BENCH_ANIMATIONS << " animations, " << idleSteps << " of "
+			  << BENCH_STEPS + PAUSED_STEPS << " steps without blits, "
+			  << blitsCount << " blits, " << stepTime << " us per step" << std::endl;
+
+	dynamic::Map root;
+	root.put("schedule_failures", schedule.count);
+	root.put("zero_duration_failures", zeroDuration.count);
+	root.put("animations", BENCH_ANIMATIONS);
+	root.put("steps", BENCH_STEPS + PAUSED_STEPS);
+	root.put("idle_steps", idleSteps);
+	root.put("blits", uint64_t(blitsCount));
+	root.put("schedule_step_us", stepTime);
+	root.put("passed", passed);
+	files::write_json(file, &root);
+	std::cout << "-- texture animation check " << (passed ? "passed" : "failed")
+			  << ", results written to " << file.u8string() << std::endl;
+	return passed;
+}
@@ -0,0 +1,19 @@
+#ifndef DEVTOOLS_ANIMATION_BENCH_H_
+#define DEVTOOLS_ANIMATION_BENCH_H_
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace devtools {
+	/* Check texture animations scheduling (no GL context required):
+	   no blits are scheduled while frames are not changed, every
+	   changed frame is blitted once, zero duration frames are skipped
+	   and animations of such frames only are stopped.
+	   Failed checks count and scheduling time are written as JSON
+	   @param file output JSON file
+	   @return true if every check passed */
+	extern bool run_animation_bench(fs::path file);
+}
+
+#endif // DEVTOOLS_ANIMATION_BENCH_H_
@@ -0,0 +1,148 @@
+#include "bench_world.h"
+
+#include "../core_defs.h"
+#include "../content/Content.h"
+#include "../content/ContentPack.h"
+#include "../lighting/Lighting.h"
+#include "../logic/scripting/scripting.h"
+#include "../voxels/Block.h"
+#include "../voxels/Chunk.h"
+#include "../voxels/Chunks.h"
+#include "../voxels/voxel.h"
+
+using namespace devtools;
+
+BenchWorld::BenchWorld(const Content* content, bench_blocks ids, uint seed)
+	: blockDefs(content->getIndices()->getBlockDefs()),
+	  content(content),
+	  ids(ids),
+	  random(seed) {
+	chunks = std::make_unique<Chunks>(
+		BENCH_W, BENCH_D, 0, 0, nullptr, &events, content
+	);
+	lighting = std::make_unique<Lighting>(content, chunks.get());
+	for (int cz = 0; cz < BENCH_D; cz++) {
+		for (int cx = 0; cx < BENCH_W; cx++) {
+			auto chunk = std::make_shared<Chunk>(cx, cz);
+			for (uint i = 0; i < CHUNK_VOL; i++) {
+				chunk->voxels[i].id = ids.air;
+			}
+			chunks->putChunk(chunk);
+			storage.store(chunk);
+		}
+	}
+}
+
+BenchWorld::~BenchWorld() {
+}
+
+void BenchWorld::put(int x, int y, int z, blockid_t id) {
+	voxel* vox = chunks->get(x, y, z);
+	if (vox) {
+		vox->id = id;
+		vox->states = 0;
+	}
+}
+
+void BenchWorld::buildLights() {
+	for (size_t i = 0; i < chunks->volume; i++) {
+		Chunk* chunk = chunks->chunks[i].get();
+		chunk->heightmap.build(chunk->voxels, blockDefs);
+		chunk->emitters.build(chunk->voxels, blockDefs);
+		chunk->updateHeights();
+		Lighting::prebuildSkyLight(chunk);
+	}
+	for (size_t i = 0; i < chunks->volume; i++) {
+		Chunk* chunk = chunks->chunks[i].get();
+		lighting->buildSkyLight(chunk->x, chunk->z);
+		lighting->onChunkLoaded(chunk->x, chunk->z, true);
+		chunk->setLighted(true);
+	}
+}
+
+void BenchWorld::set(int x, int y, int z, blockid_t id) {
+	chunks->set(x, y, z, id, 0);
+	lighting->onBlockSet(x, y, z);
+}
+
+uint BenchWorld::fill(int x1, int y1, int z1, int x2, int y2, int z2, blockid_t id) {
+	uint count = 0;
+	lighting->beginBatch();
+	for (int y = y1; y <= y2; y++) {
+		for (int z = z1; z <= z2; z++) {
+			for (int x = x1; x <= x2; x++) {
+				set(x, y, z, id);
+				count++;
+			}
+		}
+	}
+	lighting->endBatch();
+	return count;
+}
+
+blockid_t BenchWorld::getId(int x, int y, int z) {
+	voxel* vox = chunks->get(x, y, z);
+	return vox ? vox->id : ids.air;
+}
+
+int BenchWorld::getSurface(int x, int z) {
+	Chunk* chunk = chunks->getChunkByVoxel(x, 0, z);
+	if (chunk == nullptr) {
+		return -1;
+	}
+	return chunk->heightmap.getFilled(x % CHUNK_W, z % CHUNK_D)-1;
+}
+
+Content* devtools::create_bench_content(
+	bench_blocks& ids, 
+	const std::function<void(ContentBuilder&)>& addBlocks
+) {
+	ContentBuilder builder;
+	corecontent::setup(&builder);
+
+	Block& stone = builder.createBlock("bench:stone");
+	stone.pickingItem = "core:empty";
+
+	Block& glass = builder.createBlock("bench:glass");
+	glass.drawGroup = 2;
+	glass.lightPassing = true;
+	glass.skyLightPassing = true;
+	glass.pickingItem = "core:empty";
+
+	Block& lamp = builder.createBlock("bench:lamp");
+	lamp.emission[0] = 15;
+	lamp.emission[1] = 12;
+	lamp.emission[2] = 6;
+	lamp.pickingItem = "core:empty";
+
+	Block& grass = builder.createBlock("bench:grass");
+	grass.drawGroup = 1;
+	grass.model = BlockModel::xsprite;
+	grass.lightPassing = true;
+	grass.skyLightPassing = true;
+	grass.obstacle = false;
+	grass.pickingItem = "core:empty";
+
+	Block& bulb = builder.createBlock("bench:bulb");
+	bulb.emission[0] = 4;
+	bulb.emission[1] = 9;
+	bulb.emission[2] = 14;
+	bulb.lightPassing = true;
+	bulb.model = BlockModel::aabb;
+	bulb.hitbox.a = glm::vec3(0.25f);
+	bulb.hitbox.b = glm::vec3(0.75f);
+	bulb.pickingItem = "core:empty";
+
+	if (addBlocks) {
+		addBlocks(builder);
+	}
+
+	Content* content = builder.build();
+	ids.air = content->requireBlock("core:air").rt.id;
+	ids.stone = content->requireBlock("bench:stone").rt.id;
+	ids.glass = content->requireBlock("bench:glass").rt.id;
+	ids.lamp = content->requireBlock("bench:lamp").rt.id;
+	ids.grass = content->requireBlock("bench:grass").rt.id;
+	ids.bulb = content->requireBlock("bench:bulb").rt.id;
+	return content;
+}
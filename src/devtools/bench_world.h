@@ -0,0 +1,92 @@
+#ifndef DEVTOOLS_BENCH_WORLD_H_
+#define DEVTOOLS_BENCH_WORLD_H_
+
+#include <memory>
+#include <random>
+#include <functional>
+
+#include "../typedefs.h"
+#include "../constants.h"
+#include "../voxels/ChunksStorage.h"
+#include "../world/LevelEvents.h"
+
+class Block;
+class Content;
+class ContentBuilder;
+class Chunks;
+class Lighting;
+
+/* Headless synthetic world shared by devtools benches */
+namespace devtools {
+	/* Bench world size in chunks */
+	const int BENCH_W = 4;
+	const int BENCH_D = 4;
+
+	struct bench_blocks {
+		blockid_t air;
+		blockid_t stone;
+		blockid_t glass;
+		blockid_t lamp;
+		blockid_t grass;
+		blockid_t bulb;
+	};
+
+	/* World built from Chunks and Lighting only, chunks are also kept
+	   in ChunksStorage as BlocksRenderer::prepare takes neighbours from it */
+	class BenchWorld {
+		const Block* const* const blockDefs;
+		LevelEvents events;
+	public:
+		const Content* const content;
+		const int width = BENCH_W * CHUNK_W;
+		const int depth = BENCH_D * CHUNK_D;
+		const bench_blocks ids;
+		std::unique_ptr<Chunks> chunks;
+		std::unique_ptr<Lighting> lighting;
+		ChunksStorage storage {nullptr};
+		std::mt19937 random;
+
+		/* @param seed randint seed */
+		BenchWorld(const Content* content, bench_blocks ids, uint seed);
+		~BenchWorld();
+
+		/* Set voxel without lights update (world generation stage) */
+		void put(int x, int y, int z, blockid_t id);
+
+		/* Initial lights build, same order as used by ChunksController */
+		void buildLights();
+
+		/* Set block updating heightmaps and lights */
+		void set(int x, int y, int z, blockid_t id);
+
+		/* Fill box with lights updated in one batch
+		   @return number of changed blocks */
+		uint fill(int x1, int y1, int z1, int x2, int y2, int z2, blockid_t id);
+
+		blockid_t getId(int x, int y, int z);
+
+		/* @return height of the column top non-air block or -1 */
+		int getSurface(int x, int z);
+
+		int randint(int min, int max) {
+			return std::uniform_int_distribution<int>(min, max)(random);
+		}
+
+		const Block* getDef(blockid_t id) const {
+			return blockDefs[id];
+		}
+
+		const Block* const* getDefs() const {
+			return blockDefs;
+		}
+	};
+
+	/* Core content with bench blocks (see bench_blocks)
+	   @param addBlocks adds more blocks after bench ones (optional) */
+	extern Content* create_bench_content(
+		bench_blocks& ids, 
+		const std::function<void(ContentBuilder&)>& addBlocks=nullptr
+	);
+}
+
+#endif // DEVTOOLS_BENCH_WORLD_H_
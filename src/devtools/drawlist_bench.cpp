@@ -0,0 +1,194 @@
+#include "drawlist_bench.h"
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "../constants.h"
+#include "../typedefs.h"
+#include "../data/dynamic.h"
+#include "../files/files.h"
+#include "../graphics/ChunksDrawList.h"
+#include "../maths/voxmaths.h"
+#include "../util/timeutil.h"
+
+using namespace devtools;
+
+namespace {
+	const int BENCH_SEED = 2342;
+	/* Chunks padding added to load distance (see Level) */
+	const int BENCH_PADDING = 2;
+	const int BENCH_FRAMES = 2000;
+	/* Camera speed, blocks per frame */
+	const float BENCH_SPEED = 0.5f;
+	/* Part of area slots with no chunk loaded */
+	const float BENCH_EMPTY = 0.1f;
+
+	/* Stand-in for Chunk: only position is used for sorting, shared 
+	   pointers are copied the same way as chunks were */
+	struct bench_chunk {
+		int x, z;
+	};
+
+	/* Chunks area following the camera like Chunks::setCenter does */
+	struct BenchArea {
+		int w, d;
+		int ox = 0;
+		int oz = 0;
+		std::vector<std::shared_ptr<bench_chunk>> chunks;
+		std::mt19937 random {BENCH_SEED};
+
+		BenchArea(int size) : w(size), d(size), chunks(size * size) {
+		}
+
+		void setCenter(const glm::vec3& position) {
+			ox = floordiv(int(std::floor(position.x)), CHUNK_W) - w / 2;
+			oz = floordiv(int(std::floor(position.z)), CHUNK_D) - d / 2;
+			std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+			for (size_t i = 0; i < chunks.size(); i++) {
+				int x = ox + int(i % w);
+				int z = oz + int(i / w);
+				auto& chunk = chunks[i];
+				if (chunk && chunk->x == x && chunk->z == z)
+					continue;
+				if (dist(random) < BENCH_EMPTY) {
+					chunk = nullptr;
+				} else {
+					chunk = std::make_shared<bench_chunk>(bench_chunk {x, z});
+				}
+			}
+		}
+	};
+
+	/* Draw order used before ChunksDrawList: non-empty slots sorted
+	   every frame */
+	size_t sort_every_frame(const BenchArea& area, const glm::vec3& camera, 
+							std::vector<size_t>& indices) {
+		indices.clear();
+		for (size_t i = 0; i < area.chunks.size(); i++) {
+			if (area.chunks[i] == nullptr)
+				continue;
+			indices.push_back(i);
+		}
+		float px = camera.x / (float)CHUNK_W;
+		float pz = camera.z / (float)CHUNK_D;
+		auto& chunks = area.chunks;
+		std::sort(indices.begin(), indices.end(), [&chunks, px, pz](size_t i, size_t j) {
+			auto a = chunks[i];
+			auto b = chunks[j];
+			return ((a->x + 0.5f - px)*(a->x + 0.5f - px) + 
+					(a->z + 0.5f - pz)*(a->z + 0.5f - pz)
+					>
+					(b->x + 0.5f - px)*(b->x + 0.5f - px) + 
+					(b->z + 0.5f - pz)*(b->z + 0.5f - pz));
+		});
+		size_t checksum = 0;
+		for (size_t index : indices) {
+			checksum += area.chunks[index]->x;
+		}
+		return checksum;
+	}
+
+	size_t draw_list(const ChunksDrawList& list, const BenchArea& area) {
+		size_t checksum = 0;
+		for (size_t index : list.getSlots()) {
+			const auto& chunk = area.chunks[index];
+			if (chunk == nullptr)
+				continue;
+			checksum += chunk->x;
+		}
+		return checksum;
+	}
+
+	/* @return true if every slot is listed once, far to near 
+	   from the camera chunk */
+	bool check_order(const ChunksDrawList& list, const BenchArea& area, const glm::vec3& camera) {
+		const auto& slots = list.getSlots();
+		if (slots.size() != area.chunks.size())
+			return false;
+		std::vector<bool> listed(slots.size());
+		int cx = floordiv(int(std::floor(camera.x)), CHUNK_W);
+		int cz = floordiv(int(std::floor(camera.z)), CHUNK_D);
+		int prev = std::numeric_limits<int>::max();
+		for (size_t index : slots) {
+			if (index >= listed.size() || listed[index])
+				return false;
+			listed[index] = true;
+			int dx = area.ox + int(index % area.w) - cx;
+			int dz = area.oz + int(index / area.w) - cz;
+			int distance = dx * dx + dz * dz;
+			if (distance > prev)
+				return false;
+			prev = distance;
+		}
+		return true;
+	}
+
+	bool bench_distance(int loadDistance, dynamic::Map& map) {
+		BenchArea area ((loadDistance + BENCH_PADDING) * 2);
+		ChunksDrawList list;
+		std::vector<size_t> indices;
+		glm::vec3 camera (8.5f, 80.0f, 8.5f);
+		const glm::vec3 velocity = glm::normalize(glm::vec3(1.0f, 0.0f, 0.3f)) * BENCH_SPEED;
+
+		int64_t sortTime = 0;
+		int64_t listTime = 0;
+		uint sorts = 0;
+		bool passed = true;
+		size_t checksum = 0;
+		for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+			camera += velocity;
+			area.setCenter(camera);
+
+			timeutil::Timer timer;
+			checksum += sort_every_frame(area, camera, indices);
+			sortTime += timer.stop();
+
+			timer = timeutil::Timer();
+			bool sorted = list.update(area.w, area.d, area.ox, area.oz, camera);
+			checksum -= draw_list(list, area);
+			listTime += timer.stop();
+
+			if (sorted) {
+				sorts++;
+				passed &= check_order(list, area, camera);
+			}
+		}
+		map.put("load_distance", loadDistance);
+		map.put("chunks", uint64_t(area.chunks.size()));
+		map.put("frames", BENCH_FRAMES);
+		map.put("sort_frame_us", double(sortTime) / BENCH_FRAMES);
+		map.put("list_frame_us", double(listTime) / BENCH_FRAMES);
+		map.put("list_sorts", sorts);
+		// checksum keeps both orders computed, same chunks set is listed
+		map.put("checksum", checksum == 0);
+		map.put("passed", passed);
+		return passed && checksum == 0;
+	}
+}
+
+bool devtools::run_drawlist_bench(fs::path file) {
+	dynamic::Map root;
+	auto& list = root.putList("scenarios");
+	bool passed = true;
+	for (int loadDistance : {32, 48, 64}) {
+		std::cout << "-- draw list bench: load distance " << loadDistance << std::endl;
+		auto& map = list.putMap();
+		passed &= bench_distance(loadDistance, map);
+		std::cout << "  " << map.getInt("chunks", 0) << " chunks, sort every frame "
+				  << map.getNum("sort_frame_us", 0) << " us, draw list " 
+				  << map.getNum("list_frame_us", 0) << " us per frame ("
+				  << map.getInt("list_sorts", 0) << " sorts in "
+				  << BENCH_FRAMES << " frames)" << std::endl;
+	}
+	root.put("passed", passed);
+	files::write_json(file, &root);
+	std::cout << "-- draw list bench " << (passed ? "passed" : "failed")
+			  << ", results written to " << file.u8string() << std::endl;
+	return passed;
+}
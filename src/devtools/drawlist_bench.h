@@ -0,0 +1,19 @@
+#ifndef DEVTOOLS_DRAWLIST_BENCH_H_
+#define DEVTOOLS_DRAWLIST_BENCH_H_
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace devtools {
+	/* Run chunks draw order microbenchmark (no GL context required):
+	   camera flies over chunks areas of large load distances, per-frame
+	   sorting of chunks is compared with ChunksDrawList.
+	   Frame timings and sorts count of every load distance are written 
+	   as JSON
+	   @param file output JSON file
+	   @return true if draw lists are in far to near order */
+	extern bool run_drawlist_bench(fs::path file);
+}
+
+#endif // DEVTOOLS_DRAWLIST_BENCH_H_
@@ -0,0 +1,468 @@
+#include "lighting_bench.h"
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <glm/glm.hpp>
+
+#include "../constants.h"
+#include "../typedefs.h"
+#include "../content/Content.h"
+#include "../content/ContentPack.h"
+#include "../data/dynamic.h"
+#include "../files/files.h"
+#include "../lighting/Lighting.h"
+#include "../lighting/Lightmap.h"
+#include "../logic/scripting/scripting.h"
+#include "../util/timeutil.h"
+#include "../voxels/Block.h"
+#include "../voxels/Chunk.h"
+#include "../voxels/Chunks.h"
+#include "../voxels/Emitters.h"
+#include "../voxels/voxel.h"
+#include "bench_world.h"
+
+using namespace devtools;
+
+namespace {
+	const int BENCH_SEED = 4815;
+
+	/* Slow but simple lights calculation used as reference:
+	   the whole world is relaxed until nothing changes */
+	class ReferenceLights {
+		const int width;
+		const int depth;
+		std::vector<bool> passing;
+		std::vector<ubyte> sources;
+	public:
+		std::vector<ubyte> values;
+
+		ReferenceLights(BenchWorld& world, int channel);
+
+		ubyte get(int x, int y, int z) const {
+			return values[(y * depth + z) * width + x];
+		}
+	};
+
+	ReferenceLights::ReferenceLights(BenchWorld& world, int channel)
+		: width(world.width), depth(world.depth),
+		  passing(width*depth*CHUNK_H),
+		  sources(width*depth*CHUNK_H),
+		  values(width*depth*CHUNK_H) {
+		for (int z = 0; z < depth; z++) {
+			for (int x = 0; x < width; x++) {
+				bool sky = channel == 3;
+				for (int y = CHUNK_H-1; y >= 0; y--) {
+					const Block* def = world.getDef(world.getId(x, y, z));
+					size_t index = (y * depth + z) * width + x;
+					passing[index] = def->lightPassing;
+					if (!def->skyLightPassing) {
+						sky = false;
+					}
+					if (sky) {
+						sources[index] = 15;
+					} else if (channel < 3 && def->emission[channel] > 1) {
+						sources[index] = def->emission[channel];
+					}
+				}
+			}
+		}
+		values = sources;
+
+		const int offsets[] = {
+			1, -1, width, -width, width*depth, -width*depth
+		};
+		bool changed = true;
+		bool forward = true;
+		while (changed) {
+			changed = false;
+			for (int i = 0; i < width*depth*CHUNK_H; i++) {
+				int index = forward ? i : width*depth*CHUNK_H-1-i;
+				if (!passing[index]) {
+					continue;
+				}
+				int x = index % width;
+				int z = index / width % depth;
+				int y = index / (width*depth);
+				int light = values[index];
+				for (int n = 0; n < 6; n++) {
+					if ((n == 0 && x == width-1) || (n == 1 && x == 0) ||
+						(n == 2 && z == depth-1) || (n == 3 && z == 0) ||
+						(n == 4 && y == CHUNK_H-1) || (n == 5 && y == 0)) {
+						continue;
+					}
+					light = std::max(light, values[index+offsets[n]]-1);
+				}
+				if (light != values[index]) {
+					values[index] = light;
+					changed = true;
+				}
+			}
+			forward = !forward;
+		}
+	}
+
+	/* Compare world lights with reference and write result to the map */
+	bool check_lights(BenchWorld& world, dynamic::Map& map) {
+		const char* names[] = {"r", "g", "b", "s"};
+		timeutil::Timer timer;
+		bool passed = true;
+		for (int channel = 0; channel < 4; channel++) {
+			ReferenceLights reference(world, channel);
+			uint mismatches = 0;
+			int maxError = 0;
+			for (int y = 0; y < CHUNK_H; y++) {
+				for (int z = 0; z < world.depth; z++) {
+					for (int x = 0; x < world.width; x++) {
+						int expected = reference.get(x, y, z);
+						int actual = world.chunks->getLight(x, y, z, channel);
+						if (expected != actual) {
+							if (mismatches == 0) {
+								std::cerr << "  first '" << names[channel]
+										  << "' mismatch at " << x << " " << y << " " << z
+										  << ": " << actual << " (expected "
+										  << expected << ")" << std::endl;
+							}
+							mismatches++;
+							maxError = std::max(maxError, std::abs(expected-actual));
+						}
+					}
+				}
+			}
+			auto& channelMap = map.putMap(names[channel]);
+			channelMap.put("mismatches", mismatches);
+			channelMap.put("max_error", maxError);
+			if (mismatches) {
+				passed = false;
+			}
+		}
+		map.put("reference_us", timer.stop());
+		map.put("passed", passed);
+		return passed;
+	}
+
+	/* Check lights cache round trip and write sizes and timings to the map */
+	bool check_cache(BenchWorld& world, dynamic::Map& map) {
+		int64_t encodeTime = 0;
+		int64_t decodeTime = 0;
+		size_t totalSize = 0;
+		bool passed = true;
+		for (size_t i = 0; i < world.chunks->volume; i++) {
+			const Lightmap& lightmap = world.chunks->chunks[i]->lightmap;
+
+			size_t size;
+			timeutil::Timer timer;
+			std::unique_ptr<ubyte[]> data (lightmap.encode(size));
+			encodeTime += timer.stop();
+			totalSize += size;
+
+			timer = timeutil::Timer();
+			std::unique_ptr<light_t[]> lights (Lightmap::decode(data.get(), size));
+			decodeTime += timer.stop();
+
+			if (lights == nullptr || !std::equal(
+					lights.get(), lights.get()+CHUNK_VOL, lightmap.getLights())) {
+				std::cerr << "  lights cache mismatch in chunk " << i << std::endl;
+				passed = false;
+			}
+		}
+		map.put("encode_us", encodeTime);
+		map.put("decode_us", decodeTime);
+		map.put("bytes", uint64_t(totalSize));
+		map.put("passed", passed);
+		return passed;
+	}
+
+	/* Check chunks emitters indices maintained by edits match rebuilt ones */
+	bool check_emitters(BenchWorld& world, dynamic::Map& map) {
+		size_t count = 0;
+		bool passed = true;
+		for (size_t i = 0; i < world.chunks->volume; i++) {
+			const Chunk* chunk = world.chunks->chunks[i].get();
+			std::vector<uint16_t> actual = chunk->emitters.getIndices();
+			Emitters emitters;
+			emitters.build(chunk->voxels, world.getDefs());
+			std::vector<uint16_t> expected = emitters.getIndices();
+			std::sort(actual.begin(), actual.end());
+			if (actual != expected) {
+				std::cerr << "  emitters mismatch in chunk " << i << std::endl;
+				passed = false;
+			}
+			count += expected.size();
+		}
+		map.put("count", uint64_t(count));
+		map.put("passed", passed);
+		return passed;
+	}
+
+	void generate_open_field(BenchWorld& world) {
+		for (int z = 0; z < world.depth; z++) {
+			for (int x = 0; x < world.width; x++) {
+				for (int y = 0; y < 64; y++) {
+					world.put(x, y, z, world.ids.stone);
+				}
+			}
+		}
+		for (int i = 0; i < 40; i++) {
+			int x = world.randint(0, world.width-1);
+			int z = world.randint(0, world.depth-1);
+			int height = world.randint(1, 10);
+			for (int y = 64; y < 64+height; y++) {
+				world.put(x, y, z, world.ids.stone);
+			}
+		}
+		// floating slabs casting shadows
+		for (int i = 0; i < 8; i++) {
+			int sx = world.randint(0, world.width-6);
+			int sz = world.randint(0, world.depth-6);
+			int y = world.randint(70, 80);
+			blockid_t id = i % 2 ? world.ids.stone : world.ids.glass;
+			for (int z = sz; z < sz+5; z++) {
+				for (int x = sx; x < sx+5; x++) {
+					world.put(x, y, z, id);
+				}
+			}
+		}
+	}
+
+	uint edit_open_field(BenchWorld& world) {
+		const bench_blocks& ids = world.ids;
+		const blockid_t placing[] = {ids.stone, ids.glass, ids.lamp, ids.bulb};
+		uint edits = 0;
+		for (int i = 0; i < 600; i++) {
+			int x = world.randint(0, world.width-1);
+			int z = world.randint(0, world.depth-1);
+			int y = world.getSurface(x, z);
+			if (world.randint(0, 2) == 0) {
+				if (y > 0) {
+					world.set(x, y, z, ids.air);
+					edits++;
+				}
+			} else if (y+1 < CHUNK_H) {
+				world.set(x, y+1, z, placing[world.randint(0, 3)]);
+				edits++;
+			}
+		}
+		return edits;
+	}
+
+	/* Carve random walk tunnel
+	   @param edit if true, carved with lights updated (edits stage) */
+	uint carve_tunnel(BenchWorld& world, int x, int y, int z, int steps, bool edit) {
+		uint edits = 0;
+		for (int step = 0; step < steps; step++) {
+			for (int oy = -2; oy <= 2; oy++) {
+				for (int oz = -2; oz <= 2; oz++) {
+					for (int ox = -2; ox <= 2; ox++) {
+						if (ox*ox + oy*oy + oz*oz > 5) {
+							continue;
+						}
+						int vx = x+ox, vy = y+oy, vz = z+oz;
+						if (vy < 1 || world.getId(vx, vy, vz) == world.ids.air) {
+							continue;
+						}
+						if (edit) {
+							world.set(vx, vy, vz, world.ids.air);
+							edits++;
+						} else {
+							world.put(vx, vy, vz, world.ids.air);
+						}
+					}
+				}
+			}
+			x = std::clamp(x + world.randint(-1, 1), 2, world.width-3);
+			y = std::clamp(y + world.randint(-1, 1), 4, 120);
+			z = std::clamp(z + world.randint(-1, 1), 2, world.depth-3);
+			if (step % 20 == 10) {
+				if (edit) {
+					world.set(x, y, z, world.ids.lamp);
+					edits++;
+				} else {
+					world.put(x, y, z, world.ids.lamp);
+				}
+			}
+		}
+		return edits;
+	}
+
+	void generate_cave(BenchWorld& world) {
+		for (int z = 0; z < world.depth; z++) {
+			for (int x = 0; x < world.width; x++) {
+				for (int y = 0; y < 128; y++) {
+					world.put(x, y, z, world.ids.stone);
+				}
+			}
+		}
+		for (int i = 0; i < 12; i++) {
+			carve_tunnel(world,
+				world.randint(4, world.width-5),
+				world.randint(10, 110),
+				world.randint(4, world.depth-5),
+				120, false
+			);
+		}
+		// shaft to the surface
+		int sx = world.width / 2;
+		int sz = world.depth / 2;
+		for (int y = 60; y < 128; y++) {
+			for (int z = sz-1; z <= sz+1; z++) {
+				for (int x = sx-1; x <= sx+1; x++) {
+					world.put(x, y, z, world.ids.air);
+				}
+			}
+		}
+	}
+
+	uint edit_cave(BenchWorld& world) {
+		uint edits = 0;
+		for (int i = 0; i < 3; i++) {
+			edits += carve_tunnel(world,
+				world.randint(4, world.width-5),
+				world.randint(40, 100),
+				world.randint(4, world.depth-5),
+				40, true
+			);
+		}
+		// blocking tunnels back
+		for (int i = 0; i < 300; i++) {
+			int x = world.randint(0, world.width-1);
+			int y = world.randint(1, 127);
+			int z = world.randint(0, world.depth-1);
+			if (world.getId(x, y, z) == world.ids.air) {
+				world.set(x, y, z, world.ids.stone);
+				edits++;
+			}
+		}
+		return edits;
+	}
+
+	void generate_emissive_cluster(BenchWorld& world) {
+		for (int z = 0; z < world.depth; z++) {
+			for (int x = 0; x < world.width; x++) {
+				for (int y = 0; y < 40; y++) {
+					world.put(x, y, z, world.ids.stone);
+				}
+			}
+		}
+		// roof with a glass window
+		for (int z = 8; z < world.depth-8; z++) {
+			for (int x = 8; x < world.width-8; x++) {
+				bool window = x >= 28 && x < 36 && z >= 28 && z < 36;
+				world.put(x, 60, z, window ? world.ids.glass : world.ids.stone);
+			}
+		}
+	}
+
+	uint edit_emissive_cluster(BenchWorld& world) {
+		const bench_blocks& ids = world.ids;
+		std::vector<glm::ivec3> lamps;
+		uint edits = 0;
+
+		world.lighting->beginBatch();
+		for (int i = 0; i < 400; i++) {
+			glm::ivec3 pos (
+				world.randint(16, 47), world.randint(41, 58), world.randint(16, 47)
+			);
+			world.set(pos.x, pos.y, pos.z, i % 3 ? ids.lamp : ids.bulb);
+			lamps.push_back(pos);
+			edits++;
+		}
+		world.lighting->endBatch();
+
+		for (size_t i = 0; i < lamps.size(); i += 2) {
+			const glm::ivec3& pos = lamps[i];
+			world.set(pos.x, pos.y, pos.z, ids.air);
+			edits++;
+		}
+		for (int i = 0; i < 150; i++) {
+			int x = world.randint(16, 47);
+			int y = world.randint(41, 58);
+			int z = world.randint(16, 47);
+			world.set(x, y, z, i % 4 ? ids.stone : ids.glass);
+			edits++;
+		}
+		return edits;
+	}
+
+	void generate_large_removal(BenchWorld& world) {
+		for (int z = 0; z < world.depth; z++) {
+			for (int x = 0; x < world.width; x++) {
+				for (int y = 0; y < 200; y++) {
+					world.put(x, y, z, world.ids.stone);
+				}
+			}
+		}
+		for (int i = 0; i < 300; i++) {
+			world.put(
+				world.randint(0, world.width-1),
+				world.randint(80, 199),
+				world.randint(0, world.depth-1),
+				world.ids.lamp
+			);
+		}
+	}
+
+	uint edit_large_removal(BenchWorld& world) {
+		const bench_blocks& ids = world.ids;
+		uint edits = 0;
+		edits += world.fill(12, 100, 12, 51, 199, 51, ids.air);
+		edits += world.fill(20, 100, 20, 43, 139, 43, ids.stone);
+		edits += world.fill(30, 120, 30, 33, 139, 33, ids.glass);
+		return edits;
+	}
+
+	struct bench_scenario {
+		const char* name;
+		void (*generate)(BenchWorld&);
+		uint (*edit)(BenchWorld&);
+	};
+
+	const bench_scenario scenarios[] {
+		{"cave", generate_cave, edit_cave},
+		{"open_field", generate_open_field, edit_open_field},
+		{"emissive_cluster", generate_emissive_cluster, edit_emissive_cluster},
+		{"large_removal", generate_large_removal, edit_large_removal},
+	};
+}
+
+bool devtools::run_lighting_bench(fs::path file) {
+	bench_blocks ids;
+	std::unique_ptr<Content> content (create_bench_content(ids));
+
+	dynamic::Map root;
+	auto& list = root.putList("scenarios");
+	bool passed = true;
+	for (const bench_scenario& scenario : scenarios) {
+		std::cout << "-- lighting bench: " << scenario.name << std::endl;
+		auto& map = list.putMap();
+		map.put("name", scenario.name);
+
+		BenchWorld world(content.get(), ids, BENCH_SEED);
+		scenario.generate(world);
+
+		timeutil::Timer timer;
+		world.buildLights();
+		map.put("build_us", timer.stop());
+		passed &= check_lights(world, map.putMap("build_check"));
+
+		timer = timeutil::Timer();
+		uint edits = scenario.edit(world);
+		int64_t editsTime = timer.stop();
+		map.put("edits", edits);
+		map.put("edits_us", editsTime);
+		passed &= check_lights(world, map.putMap("edits_check"));
+		passed &= check_cache(world, map.putMap("cache"));
+		passed &= check_emitters(world, map.putMap("emitters"));
+
+		std::cout << "  build " << map.getInt("build_us", 0) << " us, "
+				  << edits << " edits " << editsTime << " us" << std::endl;
+	}
+	root.put("passed", passed);
+	files::write_json(file, &root);
+	std::cout << "-- lighting bench " << (passed ? "passed" : "failed")
+			  << ", results written to " << file.u8string() << std::endl;
+	return passed;
+}
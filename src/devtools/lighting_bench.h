@@ -0,0 +1,18 @@
+#ifndef DEVTOOLS_LIGHTING_BENCH_H_
+#define DEVTOOLS_LIGHTING_BENCH_H_
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace devtools {
+	/* Run headless lighting scenarios (no GL context required):
+	   synthetic worlds are lit by Lighting, edited and then compared
+	   with slow reference flood fill. Lights cache round trip is checked too.
+	   Timings and mismatches of every scenario are written as JSON
+	   @param file output JSON file
+	   @return true if all scenarios match the reference */
+	extern bool run_lighting_bench(fs::path file);
+}
+
+#endif // DEVTOOLS_LIGHTING_BENCH_H_
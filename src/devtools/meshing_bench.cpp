@@ -0,0 +1,407 @@
+#include "meshing_bench.h"
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <cmath>
+
+#include "../constants.h"
+#include "../typedefs.h"
+#include "../settings.h"
+#include "../content/Content.h"
+#include "../content/ContentLoader.h"
+#include "../content/ContentLUT.h"
+#include "../content/ContentPack.h"
+#include "../data/dynamic.h"
+#include "../files/files.h"
+#include "../files/WorldFiles.h"
+#include "../frontend/ContentGfxCache.h"
+#include "../graphics/BlocksRenderer.h"
+#include "../graphics/ChunkVertex.h"
+#include "../graphics/OcclusionCulling.h"
+#include "../lighting/Lighting.h"
+#include "../logic/scripting/scripting.h"
+#include "../util/hashutil.h"
+#include "../util/timeutil.h"
+#include "../voxels/Block.h"
+#include "../voxels/Chunk.h"
+#include "../voxels/Chunks.h"
+#include "../voxels/ChunksStorage.h"
+#include "../voxels/WorldGenerator.h"
+#include "../voxels/voxel.h"
+#include "bench_world.h"
+
+using namespace devtools;
+
+namespace {
+	const int BENCH_SEED = 1623;
+
+	/* Every chunk is built this many times, average time is taken */
+	const int BENCH_REPEATS = 5;
+
+	/* Initial buffers capacity in faces, small to test buffers growth */
+	const size_t BENCH_CAPACITY = 1024;
+
+	void generate_flat(BenchWorld& world) {
+		for (int z = 0; z < world.depth; z++) {
+			for (int x = 0; x < world.width; x++) {
+				for (int y = 0; y < 64; y++) {
+					world.put(x, y, z, world.ids.stone);
+				}
+			}
+		}
+	}
+
+	/* Smooth hills with grass, glass and lamps placed on the surface */
+	void generate_hills(BenchWorld& world) {
+		const bench_blocks& ids = world.ids;
+		for (int z = 0; z < world.depth; z++) {
+			for (int x = 0; x < world.width; x++) {
+				int height = 60 + int(std::sin(x * 0.21f) * 6 + std::cos(z * 0.17f) * 5);
+				for (int y = 0; y < height; y++) {
+					world.put(x, y, z, ids.stone);
+				}
+				int value = world.randint(0, 99);
+				if (value < 25) {
+					world.put(x, height, z, ids.grass);
+				} else if (value < 28) {
+					world.put(x, height, z, ids.glass);
+				} else if (value < 29) {
+					world.put(x, height, z, ids.lamp);
+				} else if (value < 30) {
+					world.put(x, height, z, ids.bulb);
+				}
+			}
+		}
+	}
+
+	/* Stone with random holes: many faces with non-uniform lights */
+	void generate_caves(BenchWorld& world) {
+		for (int z = 0; z < world.depth; z++) {
+			for (int x = 0; x < world.width; x++) {
+				for (int y = 0; y < 96; y++) {
+					world.put(x, y, z, world.ids.stone);
+				}
+			}
+		}
+		for (int i = 0; i < 3000; i++) {
+			int x = world.randint(0, world.width-1);
+			int y = world.randint(1, 95);
+			int z = world.randint(0, world.depth-1);
+			world.put(x, y, z, i % 50 ? world.ids.air : world.ids.lamp);
+		}
+	}
+
+	/* Worst case: every face of every block is visible */
+	void generate_checkerboard(BenchWorld& world) {
+		for (int z = 0; z < world.depth; z++) {
+			for (int x = 0; x < world.width; x++) {
+				for (int y = 0; y < 32; y++) {
+					if ((x + y + z) % 2 == 0) {
+						world.put(x, y, z, (x + z) % 4 ? world.ids.stone : world.ids.glass);
+					}
+				}
+			}
+		}
+	}
+
+	/* Terrain of the engine world generator (requires base content) */
+	void generate_terrain(BenchWorld& world) {
+		WorldGenerator generator(world.content);
+		for (size_t i = 0; i < world.chunks->volume; i++) {
+			Chunk* chunk = world.chunks->chunks[i].get();
+			generator.generate(chunk->voxels, chunk->heightmap, chunk->emitters, 
+							   chunk->x, chunk->z, BENCH_SEED);
+		}
+	}
+
+	/* Load saved chunks around the world origin, missing chunks are left 
+	   empty, blocks missing in the bench content are replaced with air */
+	void load_saved(BenchWorld& world, const fs::path& folder) {
+		DebugSettings settings;
+		WorldFiles wfile(folder, settings);
+		std::unique_ptr<ContentLUT> lut;
+		fs::path indicesFile = folder/fs::path("indices.json");
+		if (fs::is_regular_file(indicesFile)) {
+			lut.reset(ContentLUT::create(indicesFile, world.content));
+		}
+		const size_t count = world.content->getIndices()->countBlockDefs();
+		uint loaded = 0;
+		for (size_t i = 0; i < world.chunks->volume; i++) {
+			Chunk* chunk = world.chunks->chunks[i].get();
+			int x = chunk->x - BENCH_W / 2;
+			int z = chunk->z - BENCH_D / 2;
+			std::unique_ptr<ubyte[]> data (wfile.getChunk(x, z));
+			if (data == nullptr)
+				continue;
+			if (lut) {
+				Chunk::convert(data.get(), lut.get());
+			}
+			chunk->decode(data.get());
+			for (uint j = 0; j < CHUNK_VOL; j++) {
+				if (chunk->voxels[j].id >= count) {
+					chunk->voxels[j].id = world.ids.air;
+				}
+			}
+			loaded++;
+		}
+		std::cout << "  " << loaded << " saved chunks loaded" << std::endl;
+	}
+
+	typedef std::function<void(BenchWorld&)> bench_generator;
+
+	struct bench_scenario {
+		std::string name;
+		bench_generator generate;
+	};
+
+	/* Build all world chunks meshes and write timings, sizes and hash
+	   of the meshes to the map
+	   @param lod level of detail (see BlocksRenderer::build)
+	   @return false if any chunk mesh has been truncated 
+	   or exceeded the estimate */
+	bool bench_build(BenchWorld& world, BlocksRenderer& renderer, int lod, dynamic::Map& map) {
+		int64_t prepareTime = 0;
+		int64_t buildTime = 0;
+		size_t vertices = 0;
+		size_t estimated = 0;
+		size_t bytes = 0;
+		uint64_t hash = util::FNV1A_BASIS;
+		bool passed = true;
+		for (size_t i = 0; i < world.chunks->volume; i++) {
+			const Chunk* chunk = world.chunks->chunks[i].get();
+			for (int k = 0; k < BENCH_REPEATS; k++) {
+				timeutil::Timer timer;
+				renderer.prepare(chunk, &world.storage);
+				prepareTime += timer.stop();
+
+				timer = timeutil::Timer();
+				renderer.build(ALL_CHUNK_SECTIONS, lod);
+				buildTime += timer.stop();
+			}
+			vertices += renderer.getVertexCount();
+			estimated += renderer.getEstimatedVertexCount();
+			if (renderer.isOverflow()) {
+				std::cerr << "  chunk " << i << " mesh exceeded estimate" << std::endl;
+				passed = false;
+			}
+			if (renderer.isTruncated()) {
+				std::cerr << "  chunk " << i << " mesh truncated" << std::endl;
+				passed = false;
+			}
+			for (int section = 0; section < CHUNK_SECTIONS; section++) {
+				ChunkMeshData data = renderer.getMeshData(section);
+				size_t vertexBytes = data.vertexCount * chunk_vertex::SIZE * sizeof(uint32_t);
+				size_t indexBytes = data.indexCount * sizeof(int);
+				hash = util::hash_fnv1a(hash, data.vertices, vertexBytes);
+				hash = util::hash_fnv1a(hash, data.indices, indexBytes);
+				bytes += vertexBytes + indexBytes;
+			}
+		}
+		size_t count = world.chunks->volume * BENCH_REPEATS;
+		map.put("prepare_us", double(prepareTime) / count);
+		map.put("build_us", double(buildTime) / count);
+		map.put("vertices", uint64_t(vertices / world.chunks->volume));
+		map.put("estimated_vertices", uint64_t(estimated / world.chunks->volume));
+		map.put("bytes", uint64_t(bytes / world.chunks->volume));
+		map.put("hash", util::hash_to_hex(hash));
+		map.put("passed", passed);
+		return passed;
+	}
+
+	/* Find visible sections of the world from cameras above the surface 
+	   and underground, write visible sections counts, search time and 
+	   hash of visible sets to the map */
+	void bench_occlusion(BenchWorld& world, BlocksRenderer& renderer, dynamic::Map& map) {
+		OcclusionCuller culler;
+		culler.setArea(BENCH_W, BENCH_D, 0, 0);
+		for (size_t i = 0; i < world.chunks->volume; i++) {
+			const Chunk* chunk = world.chunks->chunks[i].get();
+			renderer.prepare(chunk, &world.storage);
+			renderer.build(ALL_CHUNK_SECTIONS);
+			sconnect_t sections[CHUNK_SECTIONS];
+			for (int section = 0; section < CHUNK_SECTIONS; section++) {
+				sections[section] = renderer.getConnectivity(section);
+			}
+			culler.setChunk(chunk->x, chunk->z, sections);
+		}
+		const glm::vec3 cameras[] {
+			{world.width * 0.5f, 100.5f, world.depth * 0.5f},
+			{world.width * 0.5f, 24.5f, world.depth * 0.5f},
+		};
+		const int total = BENCH_W * BENCH_D * CHUNK_SECTIONS;
+		uint64_t hash = util::FNV1A_BASIS;
+		int64_t time = 0;
+		auto& visibleList = map.putList("visible");
+		for (const glm::vec3& camera : cameras) {
+			for (int k = 0; k < BENCH_REPEATS; k++) {
+				timeutil::Timer timer;
+				culler.update(camera, nullptr);
+				time += timer.stop();
+			}
+			visibleList.put(uint64_t(culler.getVisibleCount()));
+			for (int z = 0; z < BENCH_D; z++) {
+				for (int x = 0; x < BENCH_W; x++) {
+					for (int y = 0; y < CHUNK_SECTIONS; y++) {
+						ubyte visible = culler.isVisible(x, y, z);
+						hash = util::hash_fnv1a(hash, &visible, 1);
+					}
+				}
+			}
+		}
+		map.put("sections", uint64_t(total));
+		map.put("update_us", double(time) / (BENCH_REPEATS * std::size(cameras)));
+		map.put("hash", util::hash_to_hex(hash));
+	}
+
+	/* Hashes are compared by value, golden files written before 
+	   hashes were zero-padded still match */
+	bool same_hash(const std::string& a, const std::string& b) {
+		try {
+			return std::stoull(a, nullptr, 16) == std::stoull(b, nullptr, 16);
+		} catch (const std::exception&) {
+			return false;
+		}
+	}
+
+	/* Compare mesh hash with the same scenario and mode of golden results
+	   @return false if hashes differ (missing entries are not errors) */
+	bool check_golden(const dynamic::Map* golden, 
+					  const std::string& scenario, 
+					  const std::string& mode, 
+					  dynamic::Map& map) {
+		if (golden == nullptr)
+			return true;
+		auto list = golden->list("scenarios");
+		for (size_t i = 0; list && i < list->size(); i++) {
+			auto entry = list->map(i);
+			if (entry->getStr("name", "") != scenario)
+				continue;
+			auto modeMap = entry->map(mode);
+			if (modeMap == nullptr || !modeMap->has("hash"))
+				break;
+			std::string expected = modeMap->getStr("hash", "");
+			if (!same_hash(expected, map.getStr("hash", ""))) {
+				std::cerr << "  " << scenario << " " << mode << " mesh hash " 
+						  << map.getStr("hash", "") << " does not match golden " 
+						  << expected << std::endl;
+				map.put("golden", "mismatch");
+				return false;
+			}
+			map.put("golden", "match");
+			return true;
+		}
+		map.put("golden", "missing");
+		return true;
+	}
+
+	/* Load base content pack blocks without scripts and items
+	   @return false if the pack is not found */
+	bool load_base_blocks(ContentBuilder& builder, const fs::path& resources) {
+		fs::path folder = resources/fs::path("content/base");
+		if (!fs::is_regular_file(folder/fs::path(ContentPack::PACKAGE_FILENAME)))
+			return false;
+		ContentPack pack = ContentPack::read(folder);
+		ContentLoader loader(&pack);
+		auto root = files::read_json(pack.getContentFile());
+		auto blocksarr = root->list("blocks");
+		for (size_t i = 0; blocksarr && i < blocksarr->size(); i++) {
+			std::string name = blocksarr->str(i);
+			std::string full = pack.id+":"+name;
+			Block& def = builder.createBlock(full);
+			loader.loadBlock(def, full, folder/fs::path("blocks/"+name+".json"));
+			def.pickingItem = "core:empty";
+		}
+		return true;
+	}
+}
+
+bool devtools::run_meshing_bench(fs::path file, const meshing_bench_options& options) {
+	bench_blocks ids;
+	bool base;
+	std::unique_ptr<Content> content (create_bench_content(ids, [&](ContentBuilder& builder) {
+		base = load_base_blocks(builder, options.resources);
+	}));
+	ContentGfxCache cache(content.get(), nullptr);
+	EngineSettings settings;
+	BlocksRenderer renderer(BENCH_CAPACITY, content.get(), &cache, settings);
+
+	std::unique_ptr<dynamic::Map> golden;
+	if (!options.golden.empty()) {
+		golden = files::read_json(options.golden);
+	}
+
+	std::vector<bench_scenario> scenarios {
+		{"flat", generate_flat},
+		{"hills", generate_hills},
+		{"caves", generate_caves},
+		{"checkerboard", generate_checkerboard},
+	};
+	if (base) {
+		scenarios.push_back({"terrain", generate_terrain});
+	} else {
+		std::cerr << "-- base content not found in " << options.resources.u8string() 
+				  << ", terrain is skipped" << std::endl;
+	}
+	if (!options.world.empty()) {
+		fs::path folder = options.world;
+		scenarios.push_back({"saved", [folder](BenchWorld& world) {
+			load_saved(world, folder);
+		}});
+	}
+
+	dynamic::Map root;
+	auto& list = root.putList("scenarios");
+	bool passed = true;
+	for (const bench_scenario& scenario : scenarios) {
+		std::cout << "-- meshing bench: " << scenario.name << std::endl;
+		auto& map = list.putMap();
+		map.put("name", scenario.name);
+
+		BenchWorld world(content.get(), ids, BENCH_SEED);
+		scenario.generate(world);
+		world.buildLights();
+
+		auto run = [&](const std::string& mode, int lod) -> dynamic::Map& {
+			auto& modeMap = map.putMap(mode);
+			passed &= bench_build(world, renderer, lod, modeMap);
+			passed &= check_golden(golden.get(), scenario.name, mode, modeMap);
+			return modeMap;
+		};
+
+		settings.graphics.greedyMeshing = false;
+		auto& plain = run("plain", 0);
+		settings.graphics.greedyMeshing = true;
+		auto& greedy = run("greedy", 0);
+
+		std::cout << "  prepare " << plain.getNum("prepare_us", 0) << " us, build "
+				  << plain.getNum("build_us", 0) << " us (greedy "
+				  << greedy.getNum("build_us", 0) << " us) per chunk, vertices "
+				  << plain.getInt("vertices", 0) << " (greedy " 
+				  << greedy.getInt("vertices", 0) << ")" << std::endl;
+
+		for (int lod = 1; lod <= BlocksRenderer::MAX_LOD; lod++) {
+			auto& lodMap = run("lod"+std::to_string(lod), lod);
+			std::cout << "  lod " << lod << ": build " << lodMap.getNum("build_us", 0)
+					  << " us, vertices " << lodMap.getInt("vertices", 0) << std::endl;
+		}
+
+		auto& occlusionMap = map.putMap("occlusion");
+		bench_occlusion(world, renderer, occlusionMap);
+		passed &= check_golden(golden.get(), scenario.name, "occlusion", occlusionMap);
+		auto visible = occlusionMap.list("visible");
+		std::cout << "  occlusion: " << occlusionMap.getNum("update_us", 0) 
+				  << " us, visible sections " << visible->integer(0) << " above, "
+				  << visible->integer(1) << " underground of " 
+				  << occlusionMap.getInt("sections", 0) << std::endl;
+	}
+	root.put("passed", passed);
+	files::write_json(file, &root);
+	std::cout << "-- meshing bench " << (passed ? "passed" : "failed")
+			  << ", results written to " << file.u8string() << std::endl;
+	return passed;
+}
@@ -0,0 +1,31 @@
+#ifndef DEVTOOLS_MESHING_BENCH_H_
+#define DEVTOOLS_MESHING_BENCH_H_
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace devtools {
+	struct meshing_bench_options {
+		/* Resources folder, base content pack blocks are loaded from it
+		   (without scripts) to mesh generator terrain */
+		fs::path resources;
+		/* World folder to mesh saved chunks from (optional) */
+		fs::path world;
+		/* Previous results file to compare meshes hashes with (optional) */
+		fs::path golden;
+	};
+
+	/* Run headless chunk meshing microbenchmarks (no GL context required):
+	   synthetic worlds, generator terrain and saved chunks are lit and
+	   every chunk is prepared and built by BlocksRenderer with and without
+	   greedy meshing and with every level of detail.
+	   Timings, vertex counts, mesh sizes and hashes of every scenario
+	   are written as JSON
+	   @param file output JSON file
+	   @return true if every mesh fit its size estimate, no faces
+	   were dropped and hashes match the golden file */
+	extern bool run_meshing_bench(fs::path file, const meshing_bench_options& options);
+}
+
+#endif // DEVTOOLS_MESHING_BENCH_H_
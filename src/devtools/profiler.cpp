@@ -0,0 +1,195 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "../data/dynamic.h"
+#include "../files/files.h"
+
+using namespace profiler;
+using std::chrono::steady_clock;
+
+/* Events kept per thread (~512 KB) */
+const size_t THREAD_EVENTS = 1 << 14;
+/* Frames start marks kept */
+const size_t FRAMES = 256;
+
+namespace {
+	/* Ring buffer of thread events, the mutex is only contended
+	   while the buffer is read */
+	struct ThreadEvents {
+		uint index;
+		const char* name = nullptr;
+		std::mutex mutex;
+		std::vector<event> ring;
+		/* Events recorded total */
+		size_t count = 0;
+		/* Scopes open, owner thread only */
+		uint depth = 0;
+		/* Owner thread is alive, buffer is reused by a new thread otherwise */
+		bool owned = true;
+
+		ThreadEvents(uint index) : index(index), ring(THREAD_EVENTS) {
+		}
+	};
+
+	/* Buffer of the thread, released when the thread exits */
+	struct ThreadHolder {
+		ThreadEvents* events = nullptr;
+
+		~ThreadHolder();
+	};
+
+	const steady_clock::time_point epoch = steady_clock::now();
+	std::atomic<bool> enabled {false};
+	std::mutex threadsMutex;
+	std::vector<std::unique_ptr<ThreadEvents>> threads;
+	thread_local ThreadHolder holder;
+
+	int64_t frames[FRAMES];
+	size_t framesCount = 0;
+
+	ThreadHolder::~ThreadHolder() {
+		if (events) {
+			std::lock_guard<std::mutex> lock(threadsMutex);
+			events->owned = false;
+		}
+	}
+
+	inline int64_t now() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			steady_clock::now() - epoch
+		).count();
+	}
+
+	ThreadEvents* current_thread() {
+		if (holder.events) {
+			return holder.events;
+		}
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		for (auto& thread : threads) {
+			if (!thread->owned) {
+				thread->owned = true;
+				thread->name = nullptr;
+				holder.events = thread.get();
+				return holder.events;
+			}
+		}
+		threads.push_back(std::make_unique<ThreadEvents>(threads.size()));
+		holder.events = threads.back().get();
+		return holder.events;
+	}
+
+	/* Copy events of all threads matching the predicate */
+	template<typename F>
+	void collect(std::vector<event>& dst, F predicate) {
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		for (auto& thread : threads) {
+			std::lock_guard<std::mutex> threadLock(thread->mutex);
+			size_t first = thread->count > THREAD_EVENTS ? thread->count - THREAD_EVENTS : 0;
+			for (size_t i = first; i < thread->count; i++) {
+				const event& e = thread->ring[i % THREAD_EVENTS];
+				if (predicate(e)) {
+					dst.push_back(e);
+				}
+			}
+		}
+	}
+}
+
+Scope::Scope(const char* name) : name(name), start(-1) {
+	if (!enabled.load(std::memory_order_relaxed)) {
+		return;
+	}
+	current_thread()->depth++;
+	start = now();
+}
+
+Scope::~Scope() {
+	if (start < 0) {
+		return;
+	}
+	const int64_t end = now();
+	ThreadEvents* thread = current_thread();
+	thread->depth--;
+	std::lock_guard<std::mutex> lock(thread->mutex);
+	thread->ring[thread->count % THREAD_EVENTS] = {
+		name, start, end, thread->depth, thread->index
+	};
+	thread->count++;
+}
+
+void profiler::set_enabled(bool flag) {
+	enabled = flag;
+}
+
+bool profiler::is_enabled() {
+	return enabled;
+}
+
+void profiler::set_thread_name(const char* name) {
+	ThreadEvents* thread = current_thread();
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	thread->name = name;
+}
+
+void profiler::next_frame() {
+	frames[framesCount % FRAMES] = now();
+	framesCount++;
+}
+
+bool profiler::get_last_frame(std::vector<event>& dst, int64_t& start, int64_t& end) {
+	dst.clear();
+	if (framesCount < 2) {
+		return false;
+	}
+	start = frames[(framesCount - 2) % FRAMES];
+	end = frames[(framesCount - 1) % FRAMES];
+	collect(dst, [=](const event& e) {
+		return e.start >= start ? e.start < end : e.end > start;
+	});
+	std::sort(dst.begin(), dst.end(), [](const event& a, const event& b) {
+		if (a.thread != b.thread) return a.thread < b.thread;
+		if (a.start != b.start) return a.start < b.start;
+		return a.depth < b.depth;
+	});
+	return true;
+}
+
+bool profiler::write_chrome_trace(const fs::path& file) {
+	std::vector<event> events;
+	collect(events, [](const event&) {
+		return true;
+	});
+
+	dynamic::Map root;
+	auto& list = root.putList("traceEvents");
+	{
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		for (auto& thread : threads) {
+			std::string name = thread->name
+				? thread->name : "thread " + std::to_string(thread->index);
+			auto& meta = list.putMap();
+			meta.put("name", "thread_name");
+			meta.put("ph", "M");
+			meta.put("pid", 1);
+			meta.put("tid", thread->index);
+			meta.putMap("args").put("name", name);
+		}
+	}
+	for (const event& e : events) {
+		auto& map = list.putMap();
+		map.put("name", e.name);
+		map.put("ph", "X");
+		map.put("ts", e.start);
+		map.put("dur", e.end - e.start);
+		map.put("pid", 1);
+		map.put("tid", e.thread);
+	}
+	root.put("displayTimeUnit", "ms");
+	return files::write_json(file, &root, false);
+}
@@ -0,0 +1,62 @@
+#ifndef DEVTOOLS_PROFILER_H_
+#define DEVTOOLS_PROFILER_H_
+
+#include <vector>
+#include <filesystem>
+#include "../typedefs.h"
+
+namespace fs = std::filesystem;
+
+/* Hierarchical CPU profiler. Scopes finished by every thread are kept
+   in per-thread ring buffers (old events are overwritten), frames are
+   marked by the engine main loop */
+namespace profiler {
+	/* Finished scope, time is in microseconds since profiler start */
+	struct event {
+		const char* name;
+		int64_t start;
+		int64_t end;
+		/* Scopes opened by the thread when this one started */
+		uint depth;
+		/* Profiler thread index (see set_thread_name) */
+		uint thread;
+	};
+
+	/* Scope marker, event is recorded when the marker is destroyed.
+	   Does nothing but a flag check if profiler is disabled
+	   @example:
+	       {
+	       profiler::Scope scope("Lighting::solve");
+	       ...
+	       } */
+	class Scope {
+		const char* name;
+		int64_t start;
+	public:
+		/* @param name static string (pointer is kept) */
+		Scope(const char* name);
+		~Scope();
+	};
+
+	void set_enabled(bool flag);
+	bool is_enabled();
+
+	/* Name the calling thread in timeline and trace
+	   @param name static string */
+	void set_thread_name(const char* name);
+
+	/* Mark start of the frame, main thread only */
+	void next_frame();
+
+	/* Events of the last finished frame of all threads
+	   (events intersecting the frame), sorted by thread, start and depth
+	   @param start, end frame time
+	   @return false if no frame is finished yet */
+	bool get_last_frame(std::vector<event>& dst, int64_t& start, int64_t& end);
+
+	/* Write events kept in buffers as Chrome trace JSON
+	   (chrome://tracing, Perfetto) */
+	bool write_chrome_trace(const fs::path& file);
+}
+
+#endif // DEVTOOLS_PROFILER_H_
@@ -0,0 +1,164 @@
+#include "vertex_bench.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "../typedefs.h"
+#include "../data/dynamic.h"
+#include "../files/files.h"
+#include "../graphics/ChunkVertex.h"
+#include "../util/timeutil.h"
+
+using namespace devtools;
+using namespace chunk_vertex;
+
+namespace {
+	const int BENCH_SEED = 2342;
+	const int RANDOM_VERTICES = 1 << 20;
+	/* Max x, z and y packed */
+	const uint32_t MAX_XZ = 0x7FF;
+	const uint32_t MAX_Y = 0xFFFF;
+	const float STEP = 1.0f / POSITION_SCALE;
+
+	/* Failed checks, first failures are printed */
+	struct Failures {
+		uint count = 0;
+
+		void check(bool condition, const char* name, const glm::vec3& position) {
+			if (condition)
+				return;
+			if (count < 8) {
+				std::cerr << "  " << name << " failed at (" << position.x << ", " 
+						  << position.y << ", " << position.z << ")" << std::endl;
+			}
+			count++;
+		}
+	};
+
+	bool same(const unpacked& vertex, const glm::vec3& position, 
+			  uint u, uint v, uint16_t region, uint32_t light) {
+		return vertex.position == position && vertex.u == u && vertex.v == v &&
+			   vertex.region == region && vertex.light == light;
+	}
+
+	unpacked roundtrip(const glm::vec3& position, uint u, uint v, 
+					   uint16_t region, uint32_t light) {
+		uint32_t data[SIZE];
+		pack(data, position, u, v, region, light);
+		return unpack(data);
+	}
+
+	/* Every grid step of x and z, y steps sampled, other fields at
+	   their limits so overlapping fields are noticed */
+	void check_grid(Failures& failures) {
+		for (uint32_t z = 0; z <= MAX_XZ; z++) {
+			for (uint32_t x = 0; x <= MAX_XZ; x++) {
+				uint32_t y = (x * 31 + z * 17) % (MAX_Y + 1);
+				glm::vec3 position (unpack_coord(x), unpack_coord(y), unpack_coord(z));
+				uint u = (x + z) % (MAX_TILES + 1);
+				uint v = MAX_TILES - u;
+				uint16_t region = (x & 1) ? 0xFFFF : uint16_t(z);
+				uint32_t light = (z & 1) ? 0xFFFFFFFF : x * 0x01010101;
+				failures.check(same(roundtrip(position, u, v, region, light), 
+									position, u, v, region, light), 
+							   "grid roundtrip", position);
+			}
+		}
+		for (uint32_t y = 0; y <= MAX_Y; y++) {
+			glm::vec3 position (unpack_coord(MAX_XZ), unpack_coord(y), unpack_coord(0));
+			failures.check(same(roundtrip(position, MAX_TILES, 0, 1, 0), 
+								position, MAX_TILES, 0, 1, 0), 
+						   "height roundtrip", position);
+		}
+	}
+
+	/* Positions in range are rounded to the nearest step
+	   @return max position error */
+	float check_random(Failures& failures) {
+		std::mt19937 random (BENCH_SEED);
+		std::uniform_real_distribution<float> xz(-POSITION_OFFSET, unpack_coord(MAX_XZ));
+		std::uniform_real_distribution<float> y(-POSITION_OFFSET, unpack_coord(MAX_Y));
+		float maxError = 0.0f;
+		for (int i = 0; i < RANDOM_VERTICES; i++) {
+			glm::vec3 position (xz(random), y(random), xz(random));
+			auto vertex = roundtrip(position, 0, 0, 0, 0);
+			glm::vec3 error = glm::abs(vertex.position - position);
+			float max = glm::max(error.x, glm::max(error.y, error.z));
+			maxError = glm::max(maxError, max);
+			failures.check(max <= STEP * 0.5f + 1e-4f, "rounding", position);
+		}
+		return maxError;
+	}
+
+	/* Out of range values are clamped without touching other fields */
+	void check_clamping(Failures& failures) {
+		const float low = unpack_coord(0);
+		const float highXZ = unpack_coord(MAX_XZ);
+		const float highY = unpack_coord(MAX_Y);
+		const glm::vec3 positions[] {
+			{-5.0f, -5.0f, -5.0f},
+			{-1e9f, 2.0f, 1e9f},
+			{100.0f, 5000.0f, 100.0f},
+			{1e9f, 1e9f, -1e9f},
+		};
+		for (const auto& position : positions) {
+			glm::vec3 expected (glm::clamp(position.x, low, highXZ),
+								glm::clamp(position.y, low, highY),
+								glm::clamp(position.z, low, highXZ));
+			auto vertex = roundtrip(position, 1000, 40, 0x1234, 0x89ABCDEF);
+			failures.check(same(vertex, expected, MAX_TILES, MAX_TILES, 0x1234, 0x89ABCDEF), 
+						   "clamping", position);
+		}
+	}
+
+	/* @return packing time of one vertex, nanoseconds */
+	double measure_packing(uint32_t& checksum) {
+		std::vector<uint32_t> data (RANDOM_VERTICES * SIZE);
+		timeutil::Timer timer;
+		for (int i = 0; i < RANDOM_VERTICES; i++) {
+			float t = i * STEP;
+			pack(data.data() + i * SIZE, glm::vec3(std::fmod(t, 16.0f), std::fmod(t, 256.0f), t * 0.01f), 
+				 i & MAX_TILES, (i >> 5) & MAX_TILES, uint16_t(i), uint32_t(i));
+		}
+		int64_t time = timer.stop();
+		checksum = 0;
+		for (uint32_t value : data) {
+			checksum = checksum * 31 + value;
+		}
+		return time * 1000.0 / RANDOM_VERTICES;
+	}
+}
+
+bool devtools::run_vertex_bench(fs::path file) {
+	std::cout << "-- chunk vertex check" << std::endl;
+	Failures grid;
+	check_grid(grid);
+	Failures rounding;
+	float maxError = check_random(rounding);
+	Failures clamping;
+	check_clamping(clamping);
+	uint32_t checksum;
+	double packTime = measure_packing(checksum);
+	bool passed = grid.count == 0 && rounding.count == 0 && clamping.count == 0;
+
+	std::cout << "  grid: " << grid.count << " failed, rounding: " << rounding.count
+			  << " failed (max error " << maxError << "), clamping: " 
+			  << clamping.count << " failed" << std::endl;
+	std::cout << "  packing " << packTime << " ns per vertex" << std::endl;
+
+	dynamic::Map root;
+	root.put("grid_failures", grid.count);
+	root.put("rounding_failures", rounding.count);
+	root.put("rounding_max_error", maxError);
+	root.put("clamping_failures", clamping.count);
+	root.put("pack_vertex_ns", packTime);
+	root.put("checksum", uint64_t(checksum));
+	root.put("passed", passed);
+	files::write_json(file, &root);
+	std::cout << "-- chunk vertex check " << (passed ? "passed" : "failed")
+			  << ", results written to " << file.u8string() << std::endl;
+	return passed;
+}
@@ -0,0 +1,20 @@
+#ifndef DEVTOOLS_VERTEX_BENCH_H_
+#define DEVTOOLS_VERTEX_BENCH_H_
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace devtools {
+	/* Check packed chunk vertex encoder (see graphics/ChunkVertex.h):
+	   every 1/64 position step of x, z and sampled y are packed and
+	   unpacked exactly, off-grid positions are rounded to the nearest
+	   step, out of range positions and texture coordinates are clamped
+	   and fields never overlap. Packing time is measured too.
+	   Failed cases count and timings are written as JSON
+	   @param file output JSON file
+	   @return true if every check passed */
+	extern bool run_vertex_bench(fs::path file);
+}
+
+#endif // DEVTOOLS_VERTEX_BENCH_H_
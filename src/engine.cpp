@@ -38,6 +38,7 @@
 #include "logic/scripting/scripting.h"
 
 #include "core_defs.h"
+#include "devtools/profiler.h"
 
 namespace fs = std::filesystem;
 
@@ -58,7 +59,7 @@ Engine::Engine(EngineSettings& settings, EnginePaths* paths)
     assets = std::make_unique<Assets>();
 
 
-	AssetsLoader loader(assets.get(), resPaths.get());
+	AssetsLoader loader(assets.get(), resPaths.get(), paths->getCacheFolder());
 	AssetsLoader::addDefaults(loader, nullptr);
 
     Shader::preprocessor->setPaths(resPaths.get());
@@ -106,26 +107,43 @@ void Engine::mainloop() {
 	lastTime = Window::time();
 
     std::cout << "-- initialized" << std::endl;
+	profiler::set_enabled(settings.debug.profiler);
+	profiler::set_thread_name("main");
 	while (!Window::isShouldClose()){
 		assert(screen != nullptr);
+		profiler::next_frame();
+		profiler::Scope frameScope("frame");
 		updateTimers();
 		updateHotkeys();
 
-		gui->act(delta);
-		screen->update(delta);
+		{
+			profiler::Scope scope("update");
+			gui->act(delta);
+			screen->update(delta);
+		}
 
         if (!Window::isIconified()) {
-		    screen->draw(delta);
-
-            Viewport viewport(Window::width, Window::height);
-            GfxContext ctx(nullptr, viewport, &batch);
-		    gui->draw(&ctx, assets.get());
+            {
+                profiler::Scope scope("draw");
+		        screen->draw(delta);
+            }
+            {
+                profiler::Scope scope("gui");
+                Viewport viewport(Window::width, Window::height);
+                GfxContext ctx(nullptr, viewport, &batch);
+		        gui->draw(&ctx, assets.get());
+		        Batch2D::nextFrame();
+		        Shader::nextFrame();
+            }
             
 		    Window::swapInterval(settings.display.swapInterval);
         } else {
             Window::swapInterval(1);
         }
-        Window::swapBuffers();
+        {
+            profiler::Scope scope("swap");
+            Window::swapBuffers();
+        }
 		Events::pollEvents();
 	}
 }
@@ -184,7 +202,7 @@ void Engine::loadContent() {
 
     std::unique_ptr<Assets> new_assets(new Assets());
 	std::cout << "-- loading assets" << std::endl;
-	AssetsLoader loader(new_assets.get(), resPaths.get());
+	AssetsLoader loader(new_assets.get(), resPaths.get(), paths->getCacheFolder());
     AssetsLoader::addDefaults(loader, content.get());
 	while (loader.hasNext()) {
 		if (!loader.loadNext()) {
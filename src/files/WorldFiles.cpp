@@ -30,6 +30,8 @@
 #include <cstring>
 
 const size_t BUFFER_SIZE_UNKNOWN = -1;
+// int64 content stamp of derived layers (see WorldFiles::layersStamp)
+const size_t LAYER_STAMP_SIZE = 8;
 
 regfile::regfile(fs::path filename) : file(filename) {
     if (file.length() < REGION_HEADER_SIZE)
@@ -201,16 +203,39 @@ void WorldFiles::put(Chunk* chunk){
 		region->setUnsaved(true);
 		region->put(localX, localZ, data, compressedSize);
 	}
-    /* Writing lights cache */
+    /* Writing lights cache (has own compact format, see Lightmap.cpp) */
 	if (doWriteLights && chunk->isLighted()) {
-        size_t compressedSize;
-        std::unique_ptr<ubyte[]> light_data (chunk->lightmap.encode());
-		ubyte* data = compress(light_data.get(), LIGHTMAP_DATA_LEN, compressedSize);
+        size_t size;
+		ubyte* data = chunk->lightmap.encode(size);
 
 		WorldRegion* region = getOrCreateRegion(lights, regionX, regionZ);
 		region->setUnsaved(true);
-		region->put(localX, localZ, data, compressedSize);
+		region->put(localX, localZ, data, size);
 	}
+    /* Writing heightmap prefixed with content stamp */ {
+        size_t compressedSize;
+        std::unique_ptr<ubyte[]> heights_data (chunk->heightmap.encode());
+		std::unique_ptr<ubyte[]> compressed (
+			compress(heights_data.get(), HEIGHTMAP_DATA_LEN, compressedSize));
+		ubyte* data = new ubyte[LAYER_STAMP_SIZE + compressedSize];
+		dataio::write_int64_big(layersStamp, data, 0);
+		std::memcpy(data + LAYER_STAMP_SIZE, compressed.get(), compressedSize);
+
+		WorldRegion* region = getOrCreateRegion(heights, regionX, regionZ);
+		region->setUnsaved(true);
+		region->put(localX, localZ, data, LAYER_STAMP_SIZE + compressedSize);
+    }
+    /* Writing emitters index prefixed with content stamp */ {
+        size_t size;
+        std::unique_ptr<ubyte[]> emitters_data (chunk->emitters.encode(size));
+		ubyte* data = new ubyte[LAYER_STAMP_SIZE + size];
+		dataio::write_int64_big(layersStamp, data, 0);
+		std::memcpy(data + LAYER_STAMP_SIZE, emitters_data.get(), size);
+
+		WorldRegion* region = getOrCreateRegion(emitters, regionX, regionZ);
+		region->setUnsaved(true);
+		region->put(localX, localZ, data, LAYER_STAMP_SIZE + size);
+    }
     /* Writing block inventories */
     if (!chunk->inventories.empty()){
         auto& inventories = chunk->inventories;
@@ -248,6 +273,14 @@ fs::path WorldFiles::getInventoriesFolder() const {
 	return directory/fs::path("inventories");
 }
 
+fs::path WorldFiles::getHeightsFolder() const {
+	return directory/fs::path("heights");
+}
+
+fs::path WorldFiles::getEmittersFolder() const {
+	return directory/fs::path("emitters");
+}
+
 fs::path WorldFiles::getRegionFilename(int x, int z) const {
 	return fs::path(std::to_string(x) + "_" + std::to_string(z) + ".bin");
 }
@@ -295,12 +328,40 @@ ubyte* WorldFiles::getChunk(int x, int z){
 }
 
 /* Get cached lights for chunk at x,z 
- * @return lights data or nullptr */
+ * @return lights data or nullptr (also for outdated cache format) */
 light_t* WorldFiles::getLights(int x, int z) {
-	std::unique_ptr<ubyte[]> data (getData(lights, getLightsFolder(), x, z, REGION_LAYER_LIGHTS, true));
+	uint32_t size;
+	const ubyte* data = getRawData(lights, getLightsFolder(), x, z, REGION_LAYER_LIGHTS, size);
 	if (data == nullptr)
 		return nullptr;
-	return Lightmap::decode(data.get());
+	return Lightmap::decode(data, size);
+}
+
+/* Get cached heightmap for chunk at x,z 
+ * @return encoded heightmap or nullptr (also for other content stamp) */
+ubyte* WorldFiles::getHeights(int x, int z) {
+	uint32_t size;
+	const ubyte* data = getRawData(heights, getHeightsFolder(), x, z, REGION_LAYER_HEIGHTS, size);
+	if (data == nullptr || size < LAYER_STAMP_SIZE || 
+		uint64_t(dataio::read_int64_big(data, 0)) != layersStamp)
+		return nullptr;
+	data += LAYER_STAMP_SIZE;
+	size -= LAYER_STAMP_SIZE;
+	// decoded to a heightmap sized buffer, so other sizes are rejected
+	if (extrle::decoded_size(data, size) != HEIGHTMAP_DATA_LEN)
+		return nullptr;
+	return decompress(data, size, HEIGHTMAP_DATA_LEN);
+}
+
+/* Get stored emitters index for chunk at x,z (region keeps ownership)
+ * @return encoded emitters or nullptr (also for other content stamp) */
+ubyte* WorldFiles::getEmitters(int x, int z, uint32_t& size) {
+	ubyte* data = getRawData(emitters, getEmittersFolder(), x, z, REGION_LAYER_EMITTERS, size);
+	if (data == nullptr || size < LAYER_STAMP_SIZE || 
+		uint64_t(dataio::read_int64_big(data, 0)) != layersStamp)
+		return nullptr;
+	size -= LAYER_STAMP_SIZE;
+	return data + LAYER_STAMP_SIZE;
 }
 
 chunk_inventories_map WorldFiles::fetchInventories(int x, int z) {
@@ -322,8 +383,8 @@ chunk_inventories_map WorldFiles::fetchInventories(int x, int z) {
 	return inventories;
 }
 
-ubyte* WorldFiles::getData(regionsmap& regions, const fs::path& folder, 
-                           int x, int z, int layer, bool compression) {
+ubyte* WorldFiles::getRawData(regionsmap& regions, const fs::path& folder, 
+                              int x, int z, int layer, uint32_t& size) {
 	int regionX = floordiv(x, REGION_SIZE);
 	int regionZ = floordiv(z, REGION_SIZE);
 
@@ -333,20 +394,24 @@ ubyte* WorldFiles::getData(regionsmap& regions, const fs::path& folder,
 	WorldRegion* region = getOrCreateRegion(regions, regionX, regionZ);
 	ubyte* data = region->getChunkData(localX, localZ);
 	if (data == nullptr) {
-		uint32_t size;
 		data = readChunkData(x, z, size, folder, layer);
 		if (data != nullptr) {
 			region->put(localX, localZ, data, size);
 		}
-	}
-	if (data != nullptr) {
-        size_t size = region->getChunkDataSize(localX, localZ);
-		if (compression) {
-			return decompress(data, size, CHUNK_DATA_LEN);
-		}
 		return data;
 	}
-	return nullptr;
+	size = region->getChunkDataSize(localX, localZ);
+	return data;
+}
+
+ubyte* WorldFiles::getData(regionsmap& regions, const fs::path& folder, 
+                           int x, int z, int layer, bool compression) {
+	uint32_t size;
+	ubyte* data = getRawData(regions, folder, x, z, layer, size);
+	if (data != nullptr && compression) {
+		return decompress(data, size, CHUNK_DATA_LEN);
+	}
+	return data;
 }
 
 
@@ -489,10 +554,14 @@ void WorldFiles::write(const World* world, const Content* content) {
 	fs::path regionsFolder = getRegionsFolder();
 	fs::path lightsFolder = getLightsFolder();
     fs::path inventoriesFolder = getInventoriesFolder();
+	fs::path heightsFolder = getHeightsFolder();
+	fs::path emittersFolder = getEmittersFolder();
 
 	fs::create_directories(regionsFolder);
     fs::create_directories(inventoriesFolder);
 	fs::create_directories(lightsFolder);
+	fs::create_directories(heightsFolder);
+	fs::create_directories(emittersFolder);
 
     if (world) {
 	    writeWorldInfo(world);
@@ -506,6 +575,8 @@ void WorldFiles::write(const World* world, const Content* content) {
 	writeRegions(regions, regionsFolder, REGION_LAYER_VOXELS);
 	writeRegions(lights, lightsFolder, REGION_LAYER_LIGHTS);
     writeRegions(storages, inventoriesFolder, REGION_LAYER_INVENTORIES);
+	writeRegions(heights, heightsFolder, REGION_LAYER_HEIGHTS);
+	writeRegions(emitters, emittersFolder, REGION_LAYER_EMITTERS);
 }
 
 void WorldFiles::writePacks(const World* world) {
@@ -22,6 +22,8 @@ const uint REGION_HEADER_SIZE = 10;
 const uint REGION_LAYER_VOXELS = 0;
 const uint REGION_LAYER_LIGHTS = 1;
 const uint REGION_LAYER_INVENTORIES = 2;
+const uint REGION_LAYER_HEIGHTS = 3;
+const uint REGION_LAYER_EMITTERS = 4;
 
 const uint REGION_SIZE_BIT = 5;
 const uint REGION_SIZE = (1 << (REGION_SIZE_BIT));
@@ -108,6 +110,13 @@ class WorldFiles {
 	void writeRegions(regionsmap& regions,
 					  const fs::path& folder, int layer);
 
+	/* Get chunk data stored in region as is (region keeps ownership)
+	   @param size data size destination
+	   @return data or nullptr if not found */
+	ubyte* getRawData(regionsmap& regions,
+					  const fs::path& folder,
+					  int x, int z, int layer, uint32_t& size);
+
 	ubyte* getData(regionsmap& regions,
 				   const fs::path& folder,
 				   int x, int z, int layer, bool compression);
@@ -116,6 +125,8 @@ class WorldFiles {
 
     fs::path getLightsFolder() const;
 	fs::path getInventoriesFolder() const;
+	fs::path getHeightsFolder() const;
+	fs::path getEmittersFolder() const;
 public:
     static bool parseRegionFilename(const std::string& name, int& x, int& y);
     fs::path getRegionsFolder() const;
@@ -124,10 +135,14 @@ public:
 	regionsmap regions;
     regionsmap storages;
 	regionsmap lights;
+	regionsmap heights;
+	regionsmap emitters;
 	fs::path directory;
 	std::unique_ptr<ubyte[]> compressionBuffer;
 	bool generatorTestMode;
 	bool doWriteLights;
+	/* Content stamp stored with derived layers (see ContentIndices) */
+	uint64_t layersStamp = 0;
 
 	WorldFiles(fs::path directory, const DebugSettings& settings);
 	~WorldFiles();
@@ -140,6 +155,8 @@ public:
 
 	ubyte* getChunk(int x, int z);
 	light_t* getLights(int x, int z);
+	ubyte* getHeights(int x, int z);
+	ubyte* getEmitters(int x, int z, uint32_t& size);
 	chunk_inventories_map fetchInventories(int x, int z);
 
 	bool readWorldInfo(World* world);
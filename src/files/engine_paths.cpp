@@ -8,6 +8,7 @@
 #include "WorldFiles.h"
 
 const fs::path SCREENSHOTS_FOLDER {"screenshots"};
+const fs::path CACHE_FOLDER {"cache"};
 
 fs::path EnginePaths::getUserfiles() const {
     return userfiles;
@@ -17,6 +18,14 @@ fs::path EnginePaths::getResources() const {
     return resources;
 }
 
+fs::path EnginePaths::getCacheFolder() {
+    fs::path folder = userfiles/fs::path(CACHE_FOLDER);
+    if (!fs::is_directory(folder)) {
+        fs::create_directory(folder);
+    }
+    return folder;
+}
+
 fs::path EnginePaths::getScreenshotFile(std::string ext) {
     fs::path folder = userfiles/fs::path(SCREENSHOTS_FOLDER);
     if (!fs::is_directory(folder)) {
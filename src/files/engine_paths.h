@@ -25,6 +25,8 @@ public:
     fs::path getResources() const;
     
     fs::path getScreenshotFile(std::string ext);
+    /* Folder of generated data kept between launches (may be deleted) */
+    fs::path getCacheFolder();
     fs::path getWorldsFolder();
     fs::path getWorldFolder();
     bool isWorldNameUsed(std::string name);
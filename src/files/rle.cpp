@@ -53,6 +53,24 @@ size_t extrle::decode(const ubyte* src, size_t srclen, ubyte* dst) {
 	return offset;
 }
 
+size_t extrle::decoded_size(const ubyte* src, size_t srclen) {
+	size_t size = 0;
+	for (size_t i = 0; i < srclen;) {
+		uint len = src[i++];
+		if (len & 0x80) {
+			if (i >= srclen)
+				return truncated;
+			len &= 0x7F;
+			len |= ((uint)src[i++]) << 7;
+		}
+		if (i >= srclen)
+			return truncated;
+		i++;
+		size += len + 1;
+	}
+	return size;
+}
+
 size_t extrle::encode(const ubyte* src, size_t srclen, ubyte* dst) {
 	if (srclen == 0) {
 		return 0;
@@ -10,8 +10,13 @@ namespace rle {
 
 namespace extrle {
 	constexpr uint max_sequence = 0x7FFF;
+	/* decoded_size result for truncated data */
+	constexpr size_t truncated = static_cast<size_t>(-1);
 	size_t encode(const ubyte* src, size_t length, ubyte* dst);
 	size_t decode(const ubyte* src, size_t length, ubyte* dst);
+	/* @return decoded data length (nothing is decoded)
+	   or truncated if data ends in the middle of a sequence */
+	size_t decoded_size(const ubyte* src, size_t length);
 }
 
 #endif // FILES_RLE_H_
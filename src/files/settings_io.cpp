@@ -36,12 +36,19 @@ toml::Wrapper* create_wrapper(EngineSettings& settings) {
 	graphics.add("fog-curve", &settings.graphics.fogCurve);
 	graphics.add("backlight", &settings.graphics.backlight);
 	graphics.add("frustum-culling", &settings.graphics.frustumCulling);
+	graphics.add("occlusion-culling", &settings.graphics.occlusionCulling);
+	graphics.add("multi-draw-indirect", &settings.graphics.multiDrawIndirect);
+	graphics.add("greedy-meshing", &settings.graphics.greedyMeshing);
+	graphics.add("lod-distance", &settings.graphics.lodDistance);
+	graphics.add("mesh-memory-budget", &settings.graphics.meshMemoryBudget);
 	graphics.add("skybox-resolution", &settings.graphics.skyboxResolution);
+	graphics.add("skybox-round-robin", &settings.graphics.skyboxRoundRobin);
 
 	toml::Section& debug = wrapper->add("debug");
 	debug.add("generator-test-mode", &settings.debug.generatorTestMode);
 	debug.add("show-chunk-borders", &settings.debug.showChunkBorders);
 	debug.add("do-write-lights", &settings.debug.doWriteLights);
+	debug.add("profiler", &settings.debug.profiler);
 
     toml::Section& ui = wrapper->add("ui");
     ui.add("language", &settings.ui.language);
@@ -1,5 +1,7 @@
 #include "BlocksPreview.h"
 
+#include <cmath>
+#include <iostream>
 #include <glm/ext.hpp>
 
 #include "../assets/Assets.h"
@@ -7,6 +9,7 @@
 #include "../graphics/Shader.h"
 #include "../graphics/Texture.h"
 #include "../graphics/Atlas.h"
+#include "../graphics/ImageData.h"
 #include "../graphics/Batch3D.h"
 #include "../graphics/Framebuffer.h"
 #include "../graphics/GfxContext.h"
@@ -14,9 +17,128 @@
 #include "../window/Camera.h"
 #include "../voxels/Block.h"
 #include "../content/Content.h"
+#include "../coders/png.h"
+#include "../files/files.h"
+#include "../data/dynamic.h"
+#include "../util/hashutil.h"
 #include "../constants.h"
 #include "ContentGfxCache.h"
 
+/* Change when icons rendering is changed to drop cached icons */
+const int ICONS_CACHE_VERSION = 1;
+const fs::path ICONS_IMAGE_FILE {"icons.png"};
+const fs::path ICONS_LAYOUT_FILE {"icons.json"};
+
+/* Hash of everything icons rendering depends on */
+static uint64_t hash_icons(
+    const ContentGfxCache* cache,
+    const Atlas* atlas,
+    const ContentIndices* indices
+) {
+    uint64_t hash = util::FNV1A_BASIS;
+    const int header[] {ICONS_CACHE_VERSION, ITEM_ICON_SIZE};
+    hash = util::hash_fnv1a(hash, header, sizeof(header));
+    hash = hash_image(hash, atlas->getImage());
+    size_t count = indices->countBlockDefs();
+    for (size_t i = 0; i < count; i++) {
+        auto def = indices->getBlockDef(i);
+        blockid_t id = def->rt.id;
+        hash = util::hash_fnv1a(hash, def->name);
+        hash = util::hash_fnv1a(hash, &def->model, sizeof(def->model));
+        hash = util::hash_fnv1a(hash, &def->hitbox.a, sizeof(def->hitbox.a));
+        hash = util::hash_fnv1a(hash, &def->hitbox.b, sizeof(def->hitbox.b));
+        hash = util::hash_fnv1a(hash, &def->rt.emissive, sizeof(def->rt.emissive));
+        for (int side = 0; side < 6; side++) {
+            const UVRegion& region = cache->getRegion(id, side);
+            hash = util::hash_fnv1a(hash, &region, sizeof(UVRegion));
+        }
+    }
+    return hash;
+}
+
+/* Regions are stored as pixel rects [x, y, width, height] in blocks order
+   @return nullptr if icons are not cached or are of other blocks */
+static std::unique_ptr<Atlas> read_icons(
+    const fs::path& folder,
+    const std::string& hash,
+    const ContentIndices* indices
+) {
+    fs::path layoutFile = folder/ICONS_LAYOUT_FILE;
+    fs::path imageFile = folder/ICONS_IMAGE_FILE;
+    if (!fs::is_regular_file(layoutFile) || !fs::is_regular_file(imageFile)) {
+        return nullptr;
+    }
+    try {
+        auto root = files::read_json(layoutFile);
+        if (root->getStr("hash", "") != hash) {
+            return nullptr;
+        }
+        auto list = root->list("regions");
+        size_t count = indices->countBlockDefs();
+        if (list == nullptr || list->size() != count) {
+            return nullptr;
+        }
+        std::unique_ptr<ImageData> image (png::load_image(imageFile.string()));
+        if (image == nullptr) {
+            return nullptr;
+        }
+        float unitX = 1.0f / image->getWidth();
+        float unitY = 1.0f / image->getHeight();
+        std::unordered_map<std::string, UVRegion> regions;
+        for (size_t i = 0; i < count; i++) {
+            auto rect = list->list(i);
+            if (rect == nullptr || rect->size() < 4) {
+                return nullptr;
+            }
+            int x = rect->integer(0);
+            int y = rect->integer(1);
+            int w = rect->integer(2);
+            int h = rect->integer(3);
+            if (x < 0 || y < 0 || w <= 0 || h <= 0 ||
+                x + w > int(image->getWidth()) || y + h > int(image->getHeight())) {
+                return nullptr;
+            }
+            regions[indices->getBlockDef(i)->name] = UVRegion(
+                unitX * x, unitY * y, unitX * (x + w), unitY * (y + h)
+            );
+        }
+        return std::make_unique<Atlas>(image.release(), regions);
+    } catch (const std::exception& err) {
+        std::cerr << "could not read cached icons: " << err.what() << std::endl;
+        return nullptr;
+    }
+}
+
+static void write_icons(
+    const fs::path& folder,
+    const std::string& hash,
+    const ContentIndices* indices,
+    const Atlas* atlas
+) {
+    ImageData* image = atlas->getImage();
+    // png::load_image flips rows, so the image is written flipped
+    image->flipY();
+    png::write_image((folder/ICONS_IMAGE_FILE).string(), image);
+    image->flipY();
+
+    float width = image->getWidth();
+    float height = image->getHeight();
+    dynamic::Map root;
+    root.put("hash", hash);
+    auto& list = root.putList("regions");
+    size_t count = indices->countBlockDefs();
+    for (size_t i = 0; i < count; i++) {
+        const UVRegion& region = atlas->get(indices->getBlockDef(i)->name);
+        int x = std::round(region.u1 * width);
+        int y = std::round(region.v1 * height);
+        list.putList()
+            .put(x).put(y)
+            .put(int(std::round(region.u2 * width)) - x)
+            .put(int(std::round(region.v2 * height)) - y);
+    }
+    files::write_json(folder/ICONS_LAYOUT_FILE, &root, false);
+}
+
 ImageData* BlocksPreview::draw(
     const ContentGfxCache* cache,
     Framebuffer* fbo,
@@ -61,7 +183,8 @@ ImageData* BlocksPreview::draw(
 std::unique_ptr<Atlas> BlocksPreview::build(
     const ContentGfxCache* cache,
     Assets* assets, 
-    const Content* content
+    const Content* content,
+    const fs::path& cacheFolder
 ) {
     auto indices = content->getIndices();
     size_t count = indices->countBlockDefs();
@@ -70,6 +193,15 @@ std::unique_ptr<Atlas> BlocksPreview::build(
     Shader* shader = assets->getShader("ui3d");
     Atlas* atlas = assets->getAtlas("blocks");
 
+    std::string hash;
+    if (!cacheFolder.empty()) {
+        hash = util::hash_to_hex(hash_icons(cache, atlas, indices));
+        auto icons = read_icons(cacheFolder, hash, indices);
+        if (icons) {
+            return icons;
+        }
+    }
+
     Viewport viewport(iconSize, iconSize);
     GfxContext pctx(nullptr, viewport, nullptr);
     GfxContext ctx = pctx.sub();
@@ -93,6 +225,7 @@ std::unique_ptr<Atlas> BlocksPreview::build(
     Window::viewport(0, 0, iconSize, iconSize);
     Window::setBgColor(glm::vec4(0.0f));
     
+    const uniformid_t applyUniform = shader->getUniform("u_apply");
     fbo.bind();
     for (size_t i = 0; i < count; i++) {
         auto def = indices->getBlockDef(i);
@@ -102,12 +235,16 @@ std::unique_ptr<Atlas> BlocksPreview::build(
             offset.y += (1.0f - def->hitbox.size()).y * 0.5f;
         }
         atlas->getTexture()->bind();
-        shader->uniformMatrix("u_apply", glm::translate(glm::mat4(1.0f), offset));
+        shader->uniformMatrix(applyUniform, glm::translate(glm::mat4(1.0f), offset));
 
         builder.add(def->name, draw(cache, &fbo, &batch, def, iconSize));
     }
     fbo.unbind();
 
     Window::viewport(0, 0, Window::width, Window::height);
-    return std::unique_ptr<Atlas>(builder.build(2));
+    std::unique_ptr<Atlas> icons (builder.build(2));
+    if (!hash.empty()) {
+        write_icons(cacheFolder, hash, indices, icons.get());
+    }
+    return icons;
 }
@@ -4,6 +4,9 @@
 #include "../typedefs.h"
 #include <glm/glm.hpp>
 #include <memory>
+#include <filesystem>
+
+namespace fs = std::filesystem;
 
 class Assets;
 class ImageData;
@@ -23,10 +26,15 @@ public:
         const Block* block, 
         int size);
 
+    /* Render icons of all blocks
+       @param cacheFolder folder to keep rendered icons in, icons are 
+       not rendered if blocks and their textures are not changed 
+       (empty - no cache) */
     static std::unique_ptr<Atlas> build(
         const ContentGfxCache* cache,
         Assets* assets, 
-        const Content* content);
+        const Content* content,
+        const fs::path& cacheFolder=fs::path());
 };
 
 #endif // FRONTEND_BLOCKS_PREVIEW_H_
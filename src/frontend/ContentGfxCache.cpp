@@ -1,6 +1,7 @@
 #include "ContentGfxCache.h"
 
 #include <string>
+#include <stdexcept>
 
 #include "../assets/Assets.h"
 #include "../content/Content.h"
@@ -13,24 +14,51 @@
 ContentGfxCache::ContentGfxCache(const Content* content, Assets* assets) : content(content) {
     auto indices = content->getIndices();
     sideregions = std::make_unique<UVRegion[]>(indices->countBlockDefs() * 6);
-    Atlas* atlas = assets->getAtlas("blocks");
+    sideindices = std::make_unique<regionid_t[]>(indices->countBlockDefs() * 6);
+    modelindices.resize(indices->countBlockDefs());
+    // no assets in headless mode (devtools), default region is used then
+    Atlas* atlas = assets ? assets->getAtlas("blocks") : nullptr;
+
+    // regions table index by texture name
+    std::unordered_map<std::string, regionid_t> regionsIndices;
+    auto addRegion = [&](const std::string& name, const UVRegion& region) {
+        auto found = regionsIndices.find(name);
+        if (found != regionsIndices.end()) {
+            return found->second;
+        }
+        if (regions.size() > UINT16_MAX) {
+            throw std::runtime_error("too many block textures");
+        }
+        regionid_t index = regions.size();
+        regions.push_back(region);
+        regionsIndices[name] = index;
+        return index;
+    };
+    // regions table must not be empty
+    addRegion("", UVRegion());
     
     for (uint i = 0; i < indices->countBlockDefs(); i++) {
         Block* def = indices->getBlockDef(i);
-        for (uint side = 0; side < 6; side++) {
+        for (uint side = 0; side < 6 && atlas; side++) {
             const std::string& tex = def->textureFaces[side];
             if (atlas->has(tex)) {
                 sideregions[i * 6 + side] = atlas->get(tex);
+                sideindices[i * 6 + side] = addRegion(tex, atlas->get(tex));
             } else if (atlas->has(TEXTURE_NOTFOUND)) {
                 sideregions[i * 6 + side] = atlas->get(TEXTURE_NOTFOUND);
+                sideindices[i * 6 + side] = addRegion(TEXTURE_NOTFOUND, atlas->get(TEXTURE_NOTFOUND));
             }
         }
         for (uint side = 0; side < def->modelTextures.size(); side++) {
             const std::string& tex = def->modelTextures[side];
-            if (atlas->has(tex)) {
+            if (atlas == nullptr) {
+                modelindices[i].push_back(0);
+            } else if (atlas->has(tex)) {
                 def->modelUVs.push_back(atlas->get(tex));
+                modelindices[i].push_back(addRegion(tex, atlas->get(tex)));
             } else if (atlas->has(TEXTURE_NOTFOUND)) {
                 def->modelUVs.push_back(atlas->get(TEXTURE_NOTFOUND));
+                modelindices[i].push_back(addRegion(TEXTURE_NOTFOUND, atlas->get(TEXTURE_NOTFOUND)));
             }
         }
     }
@@ -47,6 +75,10 @@ std::shared_ptr<UiDocument> ContentGfxCache::getLayout(const std::string& id) {
     return found->second;
 }
 
+const std::vector<UVRegion>& ContentGfxCache::getRegions() const {
+    return regions;
+}
+
 const Content* ContentGfxCache::getContent() const {
     return content;
 }
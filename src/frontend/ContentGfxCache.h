@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <unordered_map>
 #include "../graphics/UVRegion.h"
 #include "../typedefs.h"
@@ -13,13 +14,24 @@ class UiDocument;
 
 using uidocuments_map = std::unordered_map<std::string, std::shared_ptr<UiDocument>>;
 
+/* Index of texture region in ContentGfxCache regions table */
+using regionid_t = uint16_t;
+
 class ContentGfxCache {
     const Content* content;
     // array of block sides uv regions (6 per block)
     std::unique_ptr<UVRegion[]> sideregions;
+    // block sides regions indices (6 per block)
+    std::unique_ptr<regionid_t[]> sideindices;
+    // custom model regions indices (same order as Block::modelUVs)
+    std::vector<std::vector<regionid_t>> modelindices;
+    // all used regions, chunk meshes refer to them by index
+    std::vector<UVRegion> regions;
     // all loaded layouts
     uidocuments_map layouts;
 public:
+    /* @param assets may be nullptr (headless), then all blocks use
+       the default region */
     ContentGfxCache(const Content* content, Assets* assets);
     ~ContentGfxCache();
 
@@ -27,6 +39,16 @@ public:
         return sideregions[id * 6 + side];
     }
 
+    inline regionid_t getRegionIndex(blockid_t id, int side) const {
+        return sideindices[id * 6 + side];
+    }
+
+    inline regionid_t getModelRegionIndex(blockid_t id, size_t index) const {
+        return modelindices[id][index];
+    }
+
+    const std::vector<UVRegion>& getRegions() const;
+
     std::shared_ptr<UiDocument> getLayout(const std::string& id);
     
     const Content* getContent() const;
@@ -6,11 +6,13 @@
 #include "BlocksPreview.h"
 #include "ContentGfxCache.h"
 
-LevelFrontend::LevelFrontend(Level* level, Assets* assets) 
+LevelFrontend::LevelFrontend(Level* level, Assets* assets, const fs::path& cacheFolder) 
 : level(level),
   assets(assets),
   contentCache(std::make_unique<ContentGfxCache>(level->content, assets)),
-  blocksAtlas(BlocksPreview::build(contentCache.get(), assets, level->content)) {
+  blocksAtlas(BlocksPreview::build(
+      contentCache.get(), assets, level->content, cacheFolder
+  )) {
 }
 
 LevelFrontend::~LevelFrontend() {
@@ -2,6 +2,9 @@
 #define FRONTEND_LEVEL_FRONTEND_H_
 
 #include <memory>
+#include <filesystem>
+
+namespace fs = std::filesystem;
 
 class Atlas;
 class Level;
@@ -15,7 +18,8 @@ class LevelFrontend {
     std::unique_ptr<ContentGfxCache> contentCache;
     std::unique_ptr<Atlas> blocksAtlas;
 public:
-    LevelFrontend(Level* level, Assets* assets);
+    /* @param cacheFolder folder to keep rendered block icons in */
+    LevelFrontend(Level* level, Assets* assets, const fs::path& cacheFolder);
     ~LevelFrontend();
 
     Level* getLevel() const;
@@ -9,7 +9,10 @@
 #include "../window/Camera.h"
 #include "../content/Content.h"
 #include "../graphics/ChunksRenderer.h"
-#include "../graphics/Mesh.h"
+#include "../graphics/ChunksDrawList.h"
+#include "../graphics/ChunksDrawBatch.h"
+#include "../graphics/GeometryArena.h"
+#include "../graphics/OcclusionCulling.h"
 #include "../graphics/Atlas.h"
 #include "../graphics/Shader.h"
 #include "../graphics/Batch3D.h"
@@ -31,17 +34,48 @@
 #include "../items/ItemDef.h"
 #include "../items/ItemStack.h"
 #include "../items/Inventory.h"
+#include "../devtools/profiler.h"
 #include "LevelFrontend.h"
+#include "ContentGfxCache.h"
 #include "graphics/Skybox.h"
 
 using glm::vec3;
 using glm::vec4;
 using glm::mat4;
 
+const int REGIONS_TEXTURE_WIDTH = 256;
+
+/* Regions table texture: RGBA16 texel (u1, v1, u2, v2) per region */
+static Texture* create_regions_texture(const std::vector<UVRegion>& regions) {
+	int width = REGIONS_TEXTURE_WIDTH;
+	int height = (regions.size() + width - 1) / width;
+	std::vector<uint16_t> data(width * height * 4);
+	for (size_t i = 0; i < regions.size(); i++) {
+		const UVRegion& region = regions[i];
+		data[i * 4 + 0] = uint16_t(region.u1 * UINT16_MAX + 0.5f);
+		data[i * 4 + 1] = uint16_t(region.v1 * UINT16_MAX + 0.5f);
+		data[i * 4 + 2] = uint16_t(region.u2 * UINT16_MAX + 0.5f);
+		data[i * 4 + 3] = uint16_t(region.v2 * UINT16_MAX + 0.5f);
+	}
+	uint id;
+	glGenTextures(1, &id);
+	glBindTexture(GL_TEXTURE_2D, id);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16, width, height, 0,
+		GL_RGBA, GL_UNSIGNED_SHORT, data.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return new Texture(id, width, height);
+}
+
 WorldRenderer::WorldRenderer(Engine* engine, LevelFrontend* frontend) 
 	: engine(engine), 
 	  level(frontend->getLevel()),
 	  frustumCulling(new Frustum()),
+	  occlusionCulling(std::make_unique<OcclusionCuller>()),
+	  drawList(std::make_unique<ChunksDrawList>()),
+	  drawBatch(std::make_unique<ChunksDrawBatch>()),
 	  lineBatch(new LineBatch()),
 	  renderer(new ChunksRenderer(level, 
                 frontend->getContentGfxCache(), 
@@ -54,9 +88,26 @@ WorldRenderer::WorldRenderer(Engine* engine, LevelFrontend* frontend)
 			renderer->unload(chunk);
 		}
 	);
+	regionsTexture.reset(create_regions_texture(
+		frontend->getContentGfxCache()->getRegions()
+	));
 	auto assets = engine->getAssets();
 	skybox = new Skybox(settings.graphics.skyboxResolution, 
-						assets->getShader("skybox_gen"));
+						assets->getShader("skybox_gen"),
+						settings.graphics.skyboxRoundRobin);
+
+	Shader* shader = assets->getShader("main");
+	mainUniforms.proj = shader->getUniform("u_proj");
+	mainUniforms.view = shader->getUniform("u_view");
+	mainUniforms.gamma = shader->getUniform("u_gamma");
+	mainUniforms.fogFactor = shader->getUniform("u_fogFactor");
+	mainUniforms.fogCurve = shader->getUniform("u_fogCurve");
+	mainUniforms.cameraPos = shader->getUniform("u_cameraPos");
+	mainUniforms.cubemap = shader->getUniform("u_cubemap");
+	mainUniforms.regions = shader->getUniform("u_regions");
+	mainUniforms.torchlightColor = shader->getUniform("u_torchlightColor");
+	mainUniforms.torchlightDistance = shader->getUniform("u_torchlightDistance");
+	linesProjview = assets->getShader("lines")->getUniform("u_projview");
 }
 
 WorldRenderer::~WorldRenderer() {
@@ -68,16 +119,15 @@ WorldRenderer::~WorldRenderer() {
 
 bool WorldRenderer::drawChunk(size_t index,
 							  Camera* camera, 
-							  Shader* shader, 
-							  bool culling){
-	auto chunk = level->chunks->chunks[index];
+							  bool culling,
+							  bool occlusion){
+	Chunk* chunk = level->chunks->chunks[index].get();
+	const int x = index % level->chunks->w;
+	const int z = index / level->chunks->w;
 	if (!chunk->isLighted()) {
 		return false;
 	}
-	auto mesh = renderer->getOrRender(chunk.get());
-	if (mesh == nullptr) {
-		return false;
-	}
+	bool inFrustum = true;
 	if (culling){
 		vec3 min(chunk->x * CHUNK_W, 
 				 chunk->bottom, 
@@ -86,51 +136,85 @@ bool WorldRenderer::drawChunk(size_t index,
 				 chunk->top, 
 				 chunk->z * CHUNK_D + CHUNK_D);
 
-		if (!frustumCulling->IsBoxVisible(min, max)) return false;
+		inFrustum = frustumCulling->IsBoxVisible(min, max);
+	}
+	// occluded chunks are still queued for rebuild
+	auto mesh = renderer->getOrRender(chunk, inFrustum);
+	if (mesh == nullptr || !inFrustum) {
+		return false;
+	}
+	if (occlusion && !occlusionCulling->isVisible(x, z)) {
+		return false;
 	}
 	vec3 coord = vec3(chunk->x*CHUNK_W+0.5f, 0.5f, chunk->z*CHUNK_D+0.5f);
-	mat4 model = glm::translate(mat4(1.0f), coord);
-	shader->uniformMatrix("u_model", model);
-	mesh->draw();
+	for (int i = 0; i < CHUNK_SECTIONS; i++) {
+		auto& section = mesh->sections[i];
+		if (section == nullptr)
+			continue;
+		if (occlusion && !occlusionCulling->isVisible(x, i, z))
+			continue;
+		if (culling) {
+			vec3 min(chunk->x * CHUNK_W, 
+					 i * CHUNK_SECTION_H, 
+					 chunk->z * CHUNK_D);
+			vec3 max(chunk->x * CHUNK_W + CHUNK_W, 
+					 (i + 1) * CHUNK_SECTION_H, 
+					 chunk->z * CHUNK_D + CHUNK_D);
+			if (!frustumCulling->IsBoxVisible(min, max)) 
+				continue;
+		}
+		drawBatch->add(section->getRange(), coord);
+	}
 	return true;
 }
 
-void WorldRenderer::drawChunks(Chunks* chunks, 
-							   Camera* camera, 
-							   Shader* shader) {
-	std::vector<size_t> indices;
-	for (size_t i = 0; i < chunks->volume; i++){
-		if (chunks->chunks[i] == nullptr)
-			continue;
-		indices.push_back(i);
-	}
-	float px = camera->position.x / (float)CHUNK_W;
-	float pz = camera->position.z / (float)CHUNK_D;
-	std::sort(indices.begin(), indices.end(), [chunks, px, pz](size_t i, size_t j) {
-		auto a = chunks->chunks[i];
-		auto b = chunks->chunks[j];
-		return ((a->x + 0.5f - px)*(a->x + 0.5f - px) + 
-				(a->z + 0.5f - pz)*(a->z + 0.5f - pz)
-				>
-				(b->x + 0.5f - px)*(b->x + 0.5f - px) + 
-				(b->z + 0.5f - pz)*(b->z + 0.5f - pz));
-	});
-
-	bool culling = engine->getSettings().graphics.frustumCulling;
+void WorldRenderer::drawChunks(Chunks* chunks, Camera* camera) {
+	profiler::Scope scope("WorldRenderer::drawChunks");
+	drawList->update(chunks->w, chunks->d, chunks->ox, chunks->oz, camera->position);
+
+	auto& settings = engine->getSettings();
+	bool culling = settings.graphics.frustumCulling;
 	if (culling) {
 		frustumCulling->update(camera->getProjView());
 	}
+	bool occlusion = settings.graphics.occlusionCulling;
+	if (occlusion) {
+		profiler::Scope scope("OcclusionCuller::update");
+		occlusionCulling->setArea(chunks->w, chunks->d, chunks->ox, chunks->oz);
+		for (size_t i = 0; i < chunks->volume; i++) {
+			auto& chunk = chunks->chunks[i];
+			auto mesh = chunk ? renderer->get(chunk.get()) : nullptr;
+			occlusionCulling->setChunk(i % chunks->w, i / chunks->w, 
+									   mesh ? mesh->connectivity : nullptr);
+		}
+		occlusionCulling->update(camera->position, culling ? frustumCulling : nullptr);
+		visibleSections = occlusionCulling->getVisibleCount();
+	}
 	chunks->visible = 0;
-	for (size_t i = 0; i < indices.size(); i++){
-		chunks->visible += drawChunk(indices[i], camera, shader, culling);
+	drawBatch->clear();
+	for (size_t index : drawList->getSlots()) {
+		if (chunks->chunks[index] == nullptr)
+			continue;
+		chunks->visible += drawChunk(index, camera, culling, occlusion);
+	}
+	drawnSections = drawBatch->size();
+	{
+		profiler::Scope scope("GeometryArena::draw");
+		drawCalls = renderer->getGeometry()->draw(*drawBatch);
 	}
+	// chunks queued by drawChunk are given to mesh building threads
+	renderer->update(camera->position);
 }
 
 
 void WorldRenderer::draw(const GfxContext& pctx, Camera* camera, bool hudVisible){
+	profiler::Scope scope("WorldRenderer::draw");
     Window::clearDepth();
 	EngineSettings& settings = engine->getSettings();
-	skybox->refresh(pctx, level->world->daytime, 1.0f+fog*2.0f, 4);
+	{
+		profiler::Scope scope("Skybox::refresh");
+		skybox->refresh(pctx, level->world->daytime, 1.0f+fog*2.0f, 4);
+	}
 
 	const Content* content = level->content;
 	auto indices = content->getIndices();
@@ -155,13 +239,14 @@ void WorldRenderer::draw(const GfxContext& pctx, Camera* camera, bool hudVisible
 
 		// Setting up main shader
 		shader->use();
-		shader->uniformMatrix("u_proj", camera->getProjection());
-		shader->uniformMatrix("u_view", camera->getView());
-		shader->uniform1f("u_gamma", settings.graphics.gamma);
-		shader->uniform1f("u_fogFactor", fogFactor);
-		shader->uniform1f("u_fogCurve", settings.graphics.fogCurve);
-		shader->uniform3f("u_cameraPos", camera->position);
-		shader->uniform1i("u_cubemap", 1);
+		shader->uniformMatrix(mainUniforms.proj, camera->getProjection());
+		shader->uniformMatrix(mainUniforms.view, camera->getView());
+		shader->uniform1f(mainUniforms.gamma, settings.graphics.gamma);
+		shader->uniform1f(mainUniforms.fogFactor, fogFactor);
+		shader->uniform1f(mainUniforms.fogCurve, settings.graphics.fogCurve);
+		shader->uniform3f(mainUniforms.cameraPos, camera->position);
+		shader->uniform1i(mainUniforms.cubemap, 1);
+		shader->uniform1i(mainUniforms.regions, 2);
 		{
             auto player = level->player;
             auto inventory = player->getInventory();
@@ -169,18 +254,21 @@ void WorldRenderer::draw(const GfxContext& pctx, Camera* camera, bool hudVisible
             ItemDef* item = indices->getItemDef(stack.getItemId());
 			assert(item != nullptr);
 			float multiplier = 0.5f;
-			shader->uniform3f("u_torchlightColor",  
+			shader->uniform3f(mainUniforms.torchlightColor, glm::vec3(
 					item->emission[0] / 15.0f * multiplier,
 					item->emission[1] / 15.0f * multiplier,
-					item->emission[2] / 15.0f * multiplier);
-			shader->uniform1f("u_torchlightDistance", 6.0f);
+					item->emission[2] / 15.0f * multiplier));
+			shader->uniform1f(mainUniforms.torchlightDistance, 6.0f);
 		}
 
 		// Binding main shader textures
 		skybox->bind();
+		glActiveTexture(GL_TEXTURE2);
+		regionsTexture->bind();
+		glActiveTexture(GL_TEXTURE0);
 		atlas->getTexture()->bind();
 
-		drawChunks(level->chunks, camera, shader);
+		drawChunks(level->chunks, camera);
 
 		// Selected block
 		if (PlayerController::selectedBlockId != -1 && hudVisible){
@@ -199,7 +287,7 @@ void WorldRenderer::draw(const GfxContext& pctx, Camera* camera, bool hudVisible
 			const vec3 center = pos + hitbox.center();
 			const vec3 size = hitbox.size();
 			linesShader->use();
-			linesShader->uniformMatrix("u_projview", camera->getProjView());
+			linesShader->uniformMatrix(linesProjview, camera->getProjView());
 			lineBatch->lineWidth(2.0f);
 			lineBatch->box(center, size + vec3(0.02), vec4(0.f, 0.f, 0.f, 0.5f));
 			if (level->player->debug)
@@ -216,7 +304,7 @@ void WorldRenderer::draw(const GfxContext& pctx, Camera* camera, bool hudVisible
 		linesShader->use();
 
 		if (settings.debug.showChunkBorders){
-			linesShader->uniformMatrix("u_projview", camera->getProjView());
+			linesShader->uniformMatrix(linesProjview, camera->getProjView());
 			vec3 coord = level->player->camera->position;
 			if (coord.x < 0) coord.x--;
 			if (coord.z < 0) coord.z--;
@@ -230,7 +318,7 @@ void WorldRenderer::draw(const GfxContext& pctx, Camera* camera, bool hudVisible
 		float length = 40.f;
 		vec3 tsl = vec3(displayWidth/2, displayHeight/2, 0.f);
 		glm::mat4 model(glm::translate(glm::mat4(1.f), tsl));
-		linesShader->uniformMatrix("u_projview", glm::ortho(
+		linesShader->uniformMatrix(linesProjview, glm::ortho(
 				0.f, (float)displayWidth, 
 				0.f, (float)displayHeight,
 				-length, length) * model * glm::inverse(camera->rotation));
@@ -289,4 +377,7 @@ void WorldRenderer::drawBorders(int sx, int sy, int sz, int ex, int ey, int ez)
 	lineBatch->render();
 }
 
-float WorldRenderer::fog = 0.0f;
\ No newline at end of file
+float WorldRenderer::fog = 0.0f;
+size_t WorldRenderer::visibleSections = 0;
+size_t WorldRenderer::drawnSections = 0;
+size_t WorldRenderer::drawCalls = 0;
\ No newline at end of file
@@ -12,15 +12,18 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "../graphics/GfxContext.h"
+#include "../graphics/Shader.h"
 
 class Level;
 class Camera;
 class Batch3D;
 class LineBatch;
 class ChunksRenderer;
-class Shader;
 class Texture;
 class Frustum;
+class OcclusionCuller;
+class ChunksDrawList;
+class ChunksDrawBatch;
 class Engine;
 class Chunks;
 class LevelFrontend;
@@ -30,12 +33,36 @@ class WorldRenderer {
 	Engine* engine;
 	Level* level;
 	Frustum* frustumCulling;
+	std::unique_ptr<OcclusionCuller> occlusionCulling;
+	/* Chunks in drawing order, kept between frames */
+	std::unique_ptr<ChunksDrawList> drawList;
+	/* Visible chunk sections of the frame, drawn at once */
+	std::unique_ptr<ChunksDrawBatch> drawBatch;
 	LineBatch* lineBatch;
 	ChunksRenderer* renderer;
 	Skybox* skybox;
     std::unique_ptr<Batch3D> batch3d;
-	bool drawChunk(size_t index, Camera* camera, Shader* shader, bool culling);
-	void drawChunks(Chunks* chunks, Camera* camera, Shader* shader);
+	/* Block texture regions table used by chunk meshes */
+	std::unique_ptr<Texture> regionsTexture;
+	/* Main shader uniforms set every frame, resolved once */
+	struct {
+		uniformid_t proj;
+		uniformid_t view;
+		uniformid_t gamma;
+		uniformid_t fogFactor;
+		uniformid_t fogCurve;
+		uniformid_t cameraPos;
+		uniformid_t cubemap;
+		uniformid_t regions;
+		uniformid_t torchlightColor;
+		uniformid_t torchlightDistance;
+	} mainUniforms;
+	uniformid_t linesProjview;
+	/* Add visible sections of the chunk to drawBatch
+	   @param occlusion skip sections not found by occlusionCulling */
+	bool drawChunk(size_t index, Camera* camera, bool culling, bool occlusion);
+	/* Draw chunks with main shader in use */
+	void drawChunks(Chunks* chunks, Camera* camera);
 public:
 	WorldRenderer(Engine* engine, LevelFrontend* frontend);
 	~WorldRenderer();
@@ -45,6 +72,11 @@ public:
 	void drawBorders(int sx, int sy, int sz, int ex, int ey, int ez);
 
 	static float fog;
+	/* Sections left by occlusion culling on the last frame (debug info) */
+	static size_t visibleSections;
+	/* Chunk sections drawn and draw calls on the last frame (debug info) */
+	static size_t drawnSections;
+	static size_t drawCalls;
 };
 
 
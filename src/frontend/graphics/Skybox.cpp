@@ -1,6 +1,9 @@
 #include "Skybox.h"
 
 #include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
@@ -18,21 +21,34 @@
 const int STARS_COUNT = 3000;
 const int STARS_SEED = 632;
 
-Skybox::Skybox(uint size, Shader* shader) 
+// daytime buckets per day (~1.4 minutes of game time)
+const int SKY_TIME_BUCKETS = 1024;
+const float SKY_MIE_STEP = 1.0f / 32.0f;
+const size_t SKY_CACHE_SIZE = 4;
+
+size_t Skybox::facesRendered = 0;
+
+Skybox::Skybox(uint size, Shader* shader, bool roundRobin) 
     : size(size), 
       shader(shader), 
+      roundRobin(roundRobin),
       batch3d(new Batch3D(4096)) 
 {
-    glGenTextures(1, &cubemap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
-    glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    for (uint face = 0; face < 6; face++) {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB, size, size, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    for (size_t i = 0; i < SKY_CACHE_SIZE; i++) {
+        uint cubemap;
+        glGenTextures(1, &cubemap);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+        glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameterf(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        for (uint face = 0; face < 6; face++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB, size, size, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        }
+        cubemaps.push_back(cubemapentry {cubemap, {0, 0, 0}, false, 0});
     }
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
     glGenFramebuffers(1, &fbo);
 
     float vertices[] {
@@ -58,7 +74,9 @@ Skybox::Skybox(uint size, Shader* shader)
 }
 
 Skybox::~Skybox() {
-    glDeleteTextures(1, &cubemap);
+    for (auto& entry : cubemaps) {
+        glDeleteTextures(1, &entry.texture);
+    }
     glDeleteFramebuffers(1, &fbo);
 }
 
@@ -139,15 +157,98 @@ void Skybox::draw(
     drawStars(angle, opacity);
 }
 
+/* Sky change between refreshes too large to show with round-robin 
+   delay (daytime or fog set by hand, fast daytime speed) */
+static bool is_jump(const skykey& a, const skykey& b) {
+    int dtime = std::abs(a.time - b.time);
+    dtime = std::min(dtime, SKY_TIME_BUCKETS - dtime);
+    return dtime > 1 || std::abs(a.mie - b.mie) > 1 || a.quality != b.quality;
+}
+
+size_t Skybox::acquire(const skykey& key) {
+    size_t oldest = front;
+    for (size_t i = 0; i < cubemaps.size(); i++) {
+        if (cubemaps[i].key == key) {
+            return i;
+        }
+        if (i != front && (oldest == front || cubemaps[i].used < cubemaps[oldest].used)) {
+            oldest = i;
+        }
+    }
+    cubemapentry& entry = cubemaps[oldest];
+    entry.key = key;
+    entry.valid = false;
+    if (pending == int(oldest)) {
+        pending = -1;
+    }
+    return oldest;
+}
+
 void Skybox::refresh(const GfxContext& pctx, float t, float mie, uint quality) {
+    refreshes++;
+    int time = int(std::floor(t * SKY_TIME_BUCKETS)) % SKY_TIME_BUCKETS;
+    skykey key {
+        time < 0 ? time + SKY_TIME_BUCKETS : time,
+        int(std::round(mie / SKY_MIE_STEP)),
+        quality
+    };
+    const bool jump = is_jump(lastKey, key);
+    lastKey = key;
+    if (ready && cubemaps[front].key == key) {
+        cubemaps[front].used = refreshes;
+        pending = -1;
+        return;
+    }
+    for (size_t i = 0; i < cubemaps.size(); i++) {
+        if (cubemaps[i].valid && cubemaps[i].key == key) {
+            cubemaps[i].used = refreshes;
+            front = i;
+            pending = -1;
+            ready = true;
+            return;
+        }
+    }
+    if (!ready || !roundRobin || jump) {
+        size_t index = acquire(key);
+        cubemapentry& entry = cubemaps[index];
+        entry.used = refreshes;
+        render(pctx, entry, 0, 6);
+        entry.valid = true;
+        front = index;
+        pending = -1;
+        ready = true;
+        return;
+    }
+    // previous cubemap is drawn until all faces of the new one are rendered.
+    // Pending cubemap is finished even if the key is changed meanwhile,
+    // so the sky keeps changing when keys change faster than once per 6 refreshes
+    if (pending < 0) {
+        pending = acquire(key);
+        pendingFace = 0;
+    }
+    cubemapentry& entry = cubemaps[pending];
+    entry.used = refreshes;
+    render(pctx, entry, pendingFace, pendingFace + 1);
+    if (++pendingFace == 6) {
+        entry.valid = true;
+        front = pending;
+        pending = -1;
+    }
+}
+
+void Skybox::render(
+    const GfxContext& pctx, 
+    const cubemapentry& entry, 
+    uint firstFace, 
+    uint lastFace) 
+{
     GfxContext ctx = pctx.sub();
     ctx.depthMask(false);
     ctx.depthTest(false);
 
-    ready = true;
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, entry.texture);
     shader->use();
     Window::viewport(0,0, size, size);
 
@@ -179,19 +280,25 @@ void Skybox::refresh(const GfxContext& pctx, float t, float mie, uint quality) {
         {0.0f, 0.0f, -1.0f},
         {0.0f, 0.0f, 1.0f},
     };
-    t *= M_PI*2.0f;
+    // bucket parameters, so the cubemap is the same whenever it is rendered
+    float t = (entry.key.time + 0.5f) / SKY_TIME_BUCKETS * M_PI*2.0f;
+    float mie = entry.key.mie * SKY_MIE_STEP;
     
-    shader->uniform1i("u_quality", quality);
+    shader->uniform1i("u_quality", entry.key.quality);
     shader->uniform1f("u_mie", mie);
     shader->uniform1f("u_fog", mie - 1.0f);
     shader->uniform3f("u_lightDir", glm::normalize(glm::vec3(sin(t), -cos(t), 0.0f)));
-    for (uint face = 0; face < 6; face++) {
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, cubemap, 0);
-        shader->uniform3f("u_xaxis", xaxs[face]);
-        shader->uniform3f("u_yaxis", yaxs[face]);
-        shader->uniform3f("u_zaxis", zaxs[face]);
+    const uniformid_t xaxis = shader->getUniform("u_xaxis");
+    const uniformid_t yaxis = shader->getUniform("u_yaxis");
+    const uniformid_t zaxis = shader->getUniform("u_zaxis");
+    for (uint face = firstFace; face < lastFace; face++) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, entry.texture, 0);
+        shader->uniform3f(xaxis, xaxs[face]);
+        shader->uniform3f(yaxis, yaxs[face]);
+        shader->uniform3f(zaxis, zaxs[face]);
         mesh->draw(GL_TRIANGLES);
     }
+    facesRendered += lastFace - firstFace;
     glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
     glActiveTexture(GL_TEXTURE0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -200,7 +307,7 @@ void Skybox::refresh(const GfxContext& pctx, float t, float mie, uint quality) {
 
 void Skybox::bind() const {
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemaps[front].texture);
     glActiveTexture(GL_TEXTURE0);
 }
 
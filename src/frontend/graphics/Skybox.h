@@ -21,22 +21,64 @@ struct skysprite {
     bool emissive;
 };
 
+/* Sky parameters the cubemap is rendered with, daytime and mie
+   are quantized so close values share one cubemap */
+struct skykey {
+    int time;
+    int mie;
+    uint quality;
+
+    bool operator==(const skykey& other) const {
+        return time == other.time && mie == other.mie && quality == other.quality;
+    }
+};
+
 class Skybox {
+    struct cubemapentry {
+        uint texture;
+        skykey key;
+        bool valid;
+        /* Last refresh the cubemap was used on (LRU eviction) */
+        uint64_t used;
+    };
     uint fbo;
-    uint cubemap;
     uint size;
     Shader* shader;
     bool ready = false;
+    bool roundRobin;
     FastRandom random;
 
+    /* Rendered cubemaps cache, recently used time buckets are
+       reused without rendering */
+    std::vector<cubemapentry> cubemaps;
+    /* Cubemap being drawn */
+    size_t front = 0;
+    /* Cubemap being rendered face by face in round-robin mode,
+       -1 if none */
+    int pending = -1;
+    uint pendingFace = 0;
+    /* Key of the previous refresh */
+    skykey lastKey {};
+    uint64_t refreshes = 0;
+
     std::unique_ptr<Mesh> mesh;
     std::unique_ptr<Batch3D> batch3d;
     std::vector<skysprite> sprites;
 
     void drawStars(float angle, float opacity);
     void drawBackground(Camera* camera, Assets* assets, int width, int height);
+    /* Cached cubemap with the key or the least recently used one
+       (not front) to render into */
+    size_t acquire(const skykey& key);
+    void render(const GfxContext& pctx, const cubemapentry& entry,
+                uint firstFace, uint lastFace);
 public:
-    Skybox(uint size, Shader* shader);
+    /* Cubemap faces rendered (debug info) */
+    static size_t facesRendered;
+
+    /* @param roundRobin render one cubemap face per refresh,
+       new cubemap is shown when all faces are rendered */
+    Skybox(uint size, Shader* shader, bool roundRobin);
     ~Skybox();
 
     void draw(
@@ -46,6 +88,9 @@ public:
         float daytime,
         float fog);
 
+    /* Update cubemap if sky parameters changed past the buckets
+       @param t daytime [0.0, 1.0)
+       @param mie 1.0 + fog * 2.0 */
     void refresh(const GfxContext& pctx, float t, float mie, uint quality);
     void bind() const;
     void unbind() const;
@@ -29,7 +29,11 @@ Label::Label(std::wstring text, std::string fontName)
 }
 
 void Label::setText(std::wstring text) {
+    if (text == this->text) {
+        return;
+    }
     this->text = text;
+    layoutFont = nullptr;
 }
 
 std::wstring Label::getText() const {
@@ -44,9 +48,13 @@ void Label::draw(const GfxContext* pctx, Assets* assets) {
     auto batch = pctx->getBatch2D();
     batch->color = getColor();
     Font* font = assets->getFont(fontName);
+    if (layoutFont != font) {
+        font->layout(text, layout);
+        layoutFont = font;
+    }
     glm::vec2 size = getSize();
     glm::vec2 newsize (
-        font->calcWidth(text), 
+        layout.width, 
         font->getLineHeight()+font->getYOffset()
     );
 
@@ -62,7 +70,7 @@ void Label::draw(const GfxContext* pctx, Assets* assets) {
             break;
     }
     coord.y += (size.y-newsize.y)*0.5f;
-    font->draw(batch, text, coord.x, coord.y);
+    font->draw(batch, layout, coord.x, coord.y);
 }
 
 void Label::textSupplier(wstringsupplier supplier) {
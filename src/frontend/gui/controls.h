@@ -11,6 +11,7 @@
 #include "UINode.h"
 #include "containers.h"
 #include "../../window/input.h"
+#include "../../graphics/Font.h"
 #include "../../delegates.h"
 
 class Batch2D;
@@ -22,6 +23,9 @@ namespace gui {
         std::wstring text;
         std::string fontName;
         wstringsupplier supplier = nullptr;
+        /* Text layout is kept while text and font are not changed */
+        textlayout layout;
+        Font* layoutFont = nullptr;
     public:
         Label(std::string text, std::string fontName="normal");
         Label(std::wstring text, std::string fontName="normal");
@@ -22,6 +22,7 @@
 #include "../graphics/Font.h"
 #include "../graphics/Atlas.h"
 #include "../graphics/Mesh.h"
+#include "../graphics/ChunksRenderer.h"
 #include "../graphics/Texture.h"
 #include "../window/Camera.h"
 #include "../window/Window.h"
@@ -40,6 +41,7 @@
 #include "gui/UINode.h"
 #include "gui/GUI.h"
 #include "ContentGfxCache.h"
+#include "graphics/Skybox.h"
 #include "screens.h"
 #include "WorldRenderer.h"
 #include "BlocksPreview.h"
@@ -53,6 +55,7 @@
 #include "../items/Inventory.h"
 #include "../items/Inventories.h"
 #include "../logic/scripting/scripting.h"
+#include "../devtools/profiler.h"
 
 using namespace gui;
 
@@ -62,6 +65,58 @@ static std::shared_ptr<Label> create_label(wstringsupplier supplier) {
     return label;
 }
 
+/* Profiler scopes of the last frame as flame graph: a row per scope
+   depth, threads are placed one under another */
+static void draw_profiler_timeline(Batch2D* batch, Font* font, int x, int y, int width) {
+    static std::vector<profiler::event> events;
+    int64_t start, end;
+    if (!profiler::get_last_frame(events, start, end) || end <= start) {
+        return;
+    }
+    const int rowHeight = 16;
+    const float scale = float(width) / float(end - start);
+
+    // first row of every thread (events are sorted by thread)
+    std::vector<int> threadRows;
+    int rows = 1;
+    for (size_t i = 0; i < events.size();) {
+        const uint thread = events[i].thread;
+        uint depth = 0;
+        for (; i < events.size() && events[i].thread == thread; i++) {
+            depth = std::max(depth, events[i].depth);
+        }
+        threadRows.resize(thread + 1, 0);
+        threadRows[thread] = rows;
+        rows += depth + 1;
+    }
+
+    batch->texture(nullptr);
+    batch->rect(x, y, width, rows * rowHeight, 0, 0, 1, 1, 0, 0, 0, 0.5f);
+    for (auto& e : events) {
+        const float x1 = x + std::max(e.start - start, int64_t(0)) * scale;
+        const float x2 = x + std::min(e.end - start, end - start) * scale;
+        const int ry = y + (threadRows[e.thread] + e.depth) * rowHeight;
+        const size_t hash = std::hash<std::string>()(e.name);
+        batch->rect(x1, ry, std::max(x2 - x1 - 1, 1.0f), rowHeight - 1, 0, 0, 1, 1,
+                    0.3f + (hash & 0xFF) / 512.0f, 
+                    0.3f + ((hash >> 8) & 0xFF) / 512.0f, 
+                    0.3f + ((hash >> 16) & 0xFF) / 512.0f, 0.8f);
+    }
+
+    batch->color = glm::vec4(1.0f);
+    font->draw(batch, L"frame: " + std::to_wstring(end - start) + L" us", x + 2, y);
+    for (auto& e : events) {
+        const float x1 = x + std::max(e.start - start, int64_t(0)) * scale;
+        const float x2 = x + std::min(e.end - start, end - start) * scale;
+        std::wstring name = util::str2wstr_utf8(e.name);
+        if (x2 - x1 < font->calcWidth(name) + 4) {
+            continue;
+        }
+        const int ry = y + (threadRows[e.thread] + e.depth) * rowHeight;
+        font->draw(batch, name, x1 + 2, ry);
+    }
+}
+
 HudElement::HudElement(
     hud_element_mode mode, 
     UiDocument* document, 
@@ -112,11 +167,56 @@ std::shared_ptr<UINode> Hud::createDebugPanel(Engine* engine) {
     panel->add(create_label([](){
         return L"meshes: " + std::to_wstring(Mesh::meshesCount);
     }));
+    panel->add(create_label([](){
+        const size_t mb = 1024 * 1024;
+        return L"chunks geometry: " + 
+               std::to_wstring(ChunksRenderer::geometryUsed / mb) + L" / " +
+               std::to_wstring(ChunksRenderer::geometryCapacity / mb) + L" MB";
+    }));
+    panel->add(create_label([=](){
+        const size_t mb = 1024 * 1024;
+        uint budget = engine->getSettings().graphics.meshMemoryBudget;
+        return L"chunk meshes: " + std::to_wstring(ChunksRenderer::meshesCount) + 
+               L" (" + std::to_wstring(ChunksRenderer::meshesMemory / mb) + L" / " +
+               (budget ? std::to_wstring(budget) : std::wstring(L"-")) + L" MB)" +
+               L" evicted: " + std::to_wstring(ChunksRenderer::evictedMeshes);
+    }));
+    panel->add(create_label([](){
+        return L"uniforms per frame: " + std::to_wstring(Shader::frameUniformUploads) +
+               L" (unchanged: " + std::to_wstring(Shader::frameUniformSkips) + L")";
+    }));
+    panel->add(create_label([](){
+        return L"ui batch: " + std::to_wstring(Batch2D::frameFlushes) +
+               L" flushes, " + std::to_wstring(Batch2D::frameQuads) + L" quads";
+    }));
+    panel->add(create_label([](){
+        return L"skybox faces rendered: " + std::to_wstring(Skybox::facesRendered);
+    }));
+    panel->add(create_label([](){
+        return L"sections drawn: " + std::to_wstring(WorldRenderer::drawnSections) +
+               L" (draw calls: " + std::to_wstring(WorldRenderer::drawCalls) + L")";
+    }));
+    panel->add(create_label([](){
+        return L"mesh rebuilds: " + std::to_wstring(ChunksRenderer::rebuiltChunks) +
+               L" (sections: " + std::to_wstring(ChunksRenderer::rebuiltSections) + L")";
+    }));
+    panel->add(create_label([](){
+        return L"mesh overflows: " + std::to_wstring(ChunksRenderer::meshOverflows) +
+               L" truncated: " + std::to_wstring(ChunksRenderer::meshTruncations);
+    }));
     panel->add(create_label([=](){
         auto& settings = engine->getSettings();
         bool culling = settings.graphics.frustumCulling;
         return L"frustum-culling: "+std::wstring(culling ? L"on" : L"off");
     }));
+    panel->add(create_label([=](){
+        auto& settings = engine->getSettings();
+        if (!settings.graphics.occlusionCulling) {
+            return std::wstring(L"occlusion-culling: off");
+        }
+        return L"occlusion-culling: on (sections: "+
+               std::to_wstring(WorldRenderer::visibleSections)+L")";
+    }));
     panel->add(create_label([=]() {
         return L"chunks: "+std::to_wstring(level->chunks->chunksCount)+
                L" visible: "+std::to_wstring(level->chunks->visible);
@@ -204,6 +304,27 @@ std::shared_ptr<UINode> Hud::createDebugPanel(Engine* engine) {
         });
         panel->add(checkbox);
     }
+    {
+        auto checkbox = std::make_shared<FullCheckBox>(
+            L"Profiler", glm::vec2(400, 24)
+        );
+        checkbox->setSupplier([=]() {
+            return engine->getSettings().debug.profiler;
+        });
+        checkbox->setConsumer([=](bool checked) {
+            engine->getSettings().debug.profiler = checked;
+            profiler::set_enabled(checked);
+        });
+        panel->add(checkbox);
+    }
+    panel->add(std::make_shared<Button>(
+        L"Save Profiler Trace", glm::vec4(4.0f), [=](GUI*) {
+            auto file = engine->getPaths()->getUserfiles()/fs::path("trace.json");
+            if (profiler::write_chrome_trace(file)) {
+                std::cout << "profiler trace written to " << file.u8string() << std::endl;
+            }
+        }
+    ));
     panel->refresh();
     return panel;
 }
@@ -591,6 +712,11 @@ void Hud::draw(const GfxContext& ctx){
             batch->line(width-dmwidth+i-index, height-deltameter[j], 
                         width-dmwidth+i-index, height, 1.0f, 1.0f, 1.0f, 0.2f);
         }
+        if (profiler::is_enabled()) {
+            const int tlwidth = std::min(600, int(width)/2);
+            draw_profiler_timeline(batch, assets->getFont("normal"), 
+                                   width-tlwidth-10, 10, tlwidth);
+        }
     }
 
     if (inventoryOpen) {
@@ -84,17 +84,21 @@ void MenuScreen::draw(float delta) {
 }
 
 static bool backlight;
+static bool greedyMeshing;
 
 LevelScreen::LevelScreen(Engine* engine, Level* level) 
     : Screen(engine), 
       level(level),
-      frontend(std::make_unique<LevelFrontend>(level, engine->getAssets())),
+      frontend(std::make_unique<LevelFrontend>(
+          level, engine->getAssets(), engine->getPaths()->getCacheFolder()
+      )),
       hud(std::make_unique<Hud>(engine, frontend.get())),
       worldRenderer(std::make_unique<WorldRenderer>(engine, frontend.get())),
       controller(std::make_unique<LevelController>(engine->getSettings(), level)) {
 
     auto& settings = engine->getSettings();
     backlight = settings.graphics.backlight;
+    greedyMeshing = settings.graphics.greedyMeshing;
 
     animator.reset(new TextureAnimator());
     animator->addAnimations(engine->getAssets()->getAnimations());
@@ -149,9 +153,11 @@ void LevelScreen::update(float delta) {
     // TODO: subscribe for setting change
     EngineSettings& settings = engine->getSettings();
     level->player->camera->setFov(glm::radians(settings.camera.fov));
-    if (settings.graphics.backlight != backlight) {
+    if (settings.graphics.backlight != backlight || 
+        settings.graphics.greedyMeshing != greedyMeshing) {
         level->chunks->saveAndClear();
         backlight = settings.graphics.backlight;
+        greedyMeshing = settings.graphics.greedyMeshing;
     }
 
     if (!hud->isPause()) {
@@ -0,0 +1,92 @@
+#include "ArenaAllocator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+ArenaAllocator::ArenaAllocator(size_t capacity) : capacity(capacity) {
+	if (capacity) {
+		freeBlocks[0] = capacity;
+	}
+}
+
+size_t ArenaAllocator::allocate(size_t size) {
+	if (size == 0)
+		return NONE;
+	for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+		if (it->second < size)
+			continue;
+		size_t offset = it->first;
+		size_t left = it->second - size;
+		freeBlocks.erase(it);
+		if (left) {
+			freeBlocks[offset + size] = left;
+		}
+		used += size;
+		return offset;
+	}
+	return NONE;
+}
+
+void ArenaAllocator::free(size_t offset, size_t size) {
+	if (size == 0)
+		return;
+	if (offset + size > capacity || size > used) {
+		throw std::invalid_argument("block is out of arena");
+	}
+	auto next = freeBlocks.lower_bound(offset);
+	if (next != freeBlocks.end() && offset + size > next->first) {
+		throw std::invalid_argument("block is already free");
+	}
+	auto prev = next == freeBlocks.begin() ? freeBlocks.end() : std::prev(next);
+	if (prev != freeBlocks.end() && prev->first + prev->second > offset) {
+		throw std::invalid_argument("block is already free");
+	}
+	used -= size;
+	if (next != freeBlocks.end() && offset + size == next->first) {
+		size += next->second;
+		freeBlocks.erase(next);
+	}
+	if (prev != freeBlocks.end() && prev->first + prev->second == offset) {
+		prev->second += size;
+		return;
+	}
+	freeBlocks[offset] = size;
+}
+
+void ArenaAllocator::grow(size_t capacity) {
+	if (capacity <= this->capacity)
+		return;
+	size_t offset = this->capacity;
+	size_t size = capacity - this->capacity;
+	this->capacity = capacity;
+	// extend the last free block if it ends at the old capacity
+	if (!freeBlocks.empty()) {
+		auto last = std::prev(freeBlocks.end());
+		if (last->first + last->second == offset) {
+			last->second += size;
+			return;
+		}
+	}
+	freeBlocks[offset] = size;
+}
+
+size_t ArenaAllocator::getCapacity() const {
+	return capacity;
+}
+
+size_t ArenaAllocator::getUsed() const {
+	return used;
+}
+
+size_t ArenaAllocator::getFreeBlocks() const {
+	return freeBlocks.size();
+}
+
+size_t ArenaAllocator::getLargestFreeBlock() const {
+	size_t largest = 0;
+	for (const auto& entry : freeBlocks) {
+		largest = std::max(largest, entry.second);
+	}
+	return largest;
+}
@@ -0,0 +1,40 @@
+#ifndef GRAPHICS_ARENA_ALLOCATOR_H_
+#define GRAPHICS_ARENA_ALLOCATOR_H_
+
+#include <map>
+#include <limits>
+#include <stdlib.h>
+
+/* Free-list allocator of [0, capacity) range (in any units, e.g. 
+   vertices of a GPU buffer). Keeps no memory itself, so it is used 
+   and tested without GL context. First fit, freed blocks are merged 
+   with free neighbours */
+class ArenaAllocator {
+	/* Free blocks: offset -> size, neighbour blocks are always merged */
+	std::map<size_t, size_t> freeBlocks;
+	size_t capacity;
+	size_t used = 0;
+public:
+	static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+	ArenaAllocator(size_t capacity);
+
+	/* @return offset of the allocated block or NONE if there is 
+	   no free block of the size (see grow) */
+	size_t allocate(size_t size);
+
+	/* Return the block to the free list
+	   @param offset, size block previously allocated */
+	void free(size_t offset, size_t size);
+
+	/* Extend range, new space is free */
+	void grow(size_t capacity);
+
+	size_t getCapacity() const;
+	size_t getUsed() const;
+	/* Free blocks count (fragmentation info) */
+	size_t getFreeBlocks() const;
+	size_t getLargestFreeBlock() const;
+};
+
+#endif // GRAPHICS_ARENA_ALLOCATOR_H_
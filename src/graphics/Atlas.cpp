@@ -1,7 +1,11 @@
 #include "Atlas.h"
 
+#include <iostream>
 #include <stdexcept>
 #include "../maths/LMPacker.h"
+#include "../files/files.h"
+#include "../data/dynamic.h"
+#include "../util/hashutil.h"
 #include "Texture.h"
 #include "ImageData.h"
 
@@ -11,6 +15,9 @@ using std::unique_ptr;
 using std::shared_ptr;
 using std::unordered_map;
 
+/* Entries count from which faster skyline packing is used */
+const size_t SKYLINE_MIN_ENTRIES = 256;
+
 Atlas::Atlas(ImageData* image, 
              unordered_map<string, UVRegion> regions)
       : texture(Texture::from(image)),
@@ -31,6 +38,10 @@ const UVRegion& Atlas::get(string name) const {
     return regions.at(name);
 }
 
+const unordered_map<string, UVRegion>& Atlas::getRegions() const {
+    return regions;
+}
+
 Texture* Atlas::getTexture() const {
     return texture;
 }
@@ -48,7 +59,82 @@ bool AtlasBuilder::has(string name) const {
     return names.find(name) != names.end();
 }
 
-Atlas* AtlasBuilder::build(uint extrusion, uint maxResolution) {
+/* Hash of entries names and images, packing parameters */
+static uint64_t hash_entries(const vector<atlasentry>& entries, 
+                             uint extrusion, uint maxResolution) {
+    uint64_t hash = util::FNV1A_BASIS;
+    hash = util::hash_fnv1a(hash, &extrusion, sizeof(extrusion));
+    hash = util::hash_fnv1a(hash, &maxResolution, sizeof(maxResolution));
+    for (auto& entry : entries) {
+        hash = util::hash_fnv1a(hash, entry.name);
+        hash = hash_image(hash, entry.image.get());
+    }
+    return hash;
+}
+
+/* Read packed layout, rects are in entries order
+   @return false if file is missing or has layout of other entries */
+static bool read_layout(const fs::path& file, const string& hash, 
+                        const vector<atlasentry>& entries, uint extrusion,
+                        uint& width, uint& height, vector<rectangle>& rects) {
+    if (!fs::is_regular_file(file)) {
+        return false;
+    }
+    try {
+        auto root = files::read_json(file);
+        if (root->getStr("hash", "") != hash) {
+            return false;
+        }
+        root->num("width", width);
+        root->num("height", height);
+        auto list = root->list("rects");
+        if (list == nullptr || list->size() != entries.size()) {
+            return false;
+        }
+        for (uint i = 0; i < entries.size(); i++) {
+            auto image = entries[i].image.get();
+            auto pos = list->list(i);
+            if (pos == nullptr || pos->size() < 2) {
+                return false;
+            }
+            int x = pos->integer(0);
+            int y = pos->integer(1);
+            int w = image->getWidth();
+            int h = image->getHeight();
+            if (x < int(extrusion) || y < int(extrusion) || 
+                x + w + extrusion > width || y + h + extrusion > height) {
+                return false;
+            }
+            rects.push_back(rectangle(i, x, y, w, h));
+        }
+        return true;
+    } catch (const std::exception& err) {
+        std::cerr << "could not read atlas layout " << file.u8string() 
+                  << ": " << err.what() << std::endl;
+        return false;
+    }
+}
+
+static void write_layout(const fs::path& file, const string& hash, 
+                         uint width, uint height, const vector<rectangle>& rects) {
+    vector<const rectangle*> ordered(rects.size());
+    for (auto& rect : rects) {
+        ordered[rect.idx] = &rect;
+    }
+    dynamic::Map root;
+    root.put("hash", hash);
+    root.put("width", width);
+    root.put("height", height);
+    auto& list = root.putList("rects");
+    for (auto rect : ordered) {
+        list.putList().put(rect->x).put(rect->y);
+    }
+    files::write_json(file, &root, false);
+}
+
+/* Pack entries into the smallest atlas (power of two sizes) */
+static vector<rectangle> pack(const vector<atlasentry>& entries, uint extrusion, 
+                              uint maxResolution, uint& width, uint& height) {
     unique_ptr<uint[]> sizes (new uint[entries.size() * 2]);
     uint index = 0;
     for (auto& entry : entries) {
@@ -59,9 +145,11 @@ Atlas* AtlasBuilder::build(uint extrusion, uint maxResolution) {
     LMPacker packer(sizes.get(), entries.size()*2);
     sizes.reset(nullptr);
 
-    uint width = 32;
-    uint height = 32;
-    while (!packer.buildCompact(width, height, extrusion)) {
+    const bool skyline = entries.size() >= SKYLINE_MIN_ENTRIES;
+    width = 32;
+    height = 32;
+    while (skyline ? !packer.buildSkyline(width, height, extrusion)
+                   : !packer.buildCompact(width, height, extrusion)) {
         if (width > height) {
             height *= 2;
         } else {
@@ -72,10 +160,27 @@ Atlas* AtlasBuilder::build(uint extrusion, uint maxResolution) {
                                      std::to_string(maxResolution)+" exceeded");
         }
     }
+    return packer.getResult();
+}
+
+Atlas* AtlasBuilder::build(uint extrusion, uint maxResolution, const fs::path& cacheFile) {
+    uint width;
+    uint height;
+    vector<rectangle> rects;
+    string hash;
+    if (!cacheFile.empty()) {
+        hash = util::hash_to_hex(hash_entries(entries, extrusion, maxResolution));
+    }
+    if (hash.empty() || 
+        !read_layout(cacheFile, hash, entries, extrusion, width, height, rects)) {
+        rects = pack(entries, extrusion, maxResolution, width, height);
+        if (!hash.empty()) {
+            write_layout(cacheFile, hash, width, height, rects);
+        }
+    }
 
     unordered_map<string, UVRegion> regions;
     unique_ptr<ImageData> canvas (new ImageData(ImageFormat::rgba8888, width, height));
-    vector<rectangle> rects = packer.getResult();
     for (uint i = 0; i < entries.size(); i++) {
         const rectangle& rect = rects[i];
         const atlasentry& entry = entries[rect.idx];
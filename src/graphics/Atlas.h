@@ -5,10 +5,13 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <filesystem>
 #include <unordered_map>
 #include "UVRegion.h"
 #include "../typedefs.h"
 
+namespace fs = std::filesystem;
+
 class ImageData;
 class Texture;
 
@@ -22,6 +25,7 @@ public:
 
     bool has(std::string name) const;
     const UVRegion& get(std::string name) const;
+    const std::unordered_map<std::string, UVRegion>& getRegions() const;
 
     Texture* getTexture() const;
     ImageData* getImage() const;
@@ -42,7 +46,10 @@ public:
     bool has(std::string name) const;
     const std::set<std::string>& getNames() { return names; };
 
-    Atlas* build(uint extrusion, uint maxResolution=8192);
+    /* @param cacheFile file to keep packed layout in: packing is skipped
+       if the file has layout of the same entries (empty - no cache) */
+    Atlas* build(uint extrusion, uint maxResolution=8192, 
+                 const fs::path& cacheFile=fs::path());
 };
 
 #endif // GRAPHICS_ATLAS_H_
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <GL/glew.h>
 
 const uint B2D_VERTEX_SIZE = 8;
+const uint B2D_QUAD_SIZE = 12;
 
 using glm::vec2;
 using glm::vec3;
@@ -20,6 +21,22 @@ Batch2D::Batch2D(size_t capacity) : capacity(capacity), color(1.0f){
 	mesh = std::make_unique<Mesh>(buffer, 0, attrs);
 	index = 0;
 
+	quadsBuffer = new float[capacity * B2D_QUAD_SIZE];
+	quadsCount = 0;
+	glGenVertexArrays(1, &quadsVAO);
+	glGenBuffers(1, &quadsVBO);
+	glBindVertexArray(quadsVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, quadsVBO);
+	// ui shader quad attributes (locations 3-5), per instance
+	for (uint i = 0; i < 3; i++) {
+		glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, 
+							  B2D_QUAD_SIZE * sizeof(float), (GLvoid*)(i * 4 * sizeof(float)));
+		glVertexAttribDivisor(3 + i, 1);
+		glEnableVertexAttribArray(3 + i);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
 	ubyte pixels[] = {
 		0xFF, 0xFF, 0xFF, 0xFF
 	};
@@ -28,7 +45,10 @@ Batch2D::Batch2D(size_t capacity) : capacity(capacity), color(1.0f){
 }
 
 Batch2D::~Batch2D(){
+	glDeleteVertexArrays(1, &quadsVAO);
+	glDeleteBuffers(1, &quadsVBO);
 	delete blank;
+	delete[] quadsBuffer;
 	delete[] buffer;
 }
 
@@ -63,6 +83,36 @@ void Batch2D::vertex(vec2 point,
 	buffer[index++] = a;
 }
 
+void Batch2D::quad(float x, float y, float w, float h,
+		float u1, float v1, float u2, float v2,
+		float r, float g, float b, float a) {
+	// vertices are drawn first to keep drawing order
+	if (index)
+		render(GL_TRIANGLES);
+	if (quadsCount == capacity)
+		renderQuads();
+	float* dst = quadsBuffer + quadsCount * B2D_QUAD_SIZE;
+	dst[0] = x;
+	dst[1] = y;
+	dst[2] = w;
+	dst[3] = h;
+	dst[4] = u1;
+	dst[5] = v1;
+	dst[6] = u2;
+	dst[7] = v2;
+	dst[8] = r;
+	dst[9] = g;
+	dst[10] = b;
+	dst[11] = a;
+	quadsCount++;
+}
+
+void Batch2D::reserve(size_t vertices) {
+	renderQuads();
+	if (index + vertices * B2D_VERTEX_SIZE > capacity * B2D_VERTEX_SIZE)
+		render(GL_TRIANGLES);
+}
+
 void Batch2D::texture(Texture* new_texture){
 	if (_texture == new_texture)
 		return;
@@ -75,16 +125,14 @@ void Batch2D::texture(Texture* new_texture){
 }
 
 void Batch2D::point(float x, float y, float r, float g, float b, float a){
-	if (index + 6*B2D_VERTEX_SIZE >= capacity)
-		render(GL_TRIANGLES);
+	reserve(1);
 
 	vertex(x, y, 0, 0, r,g,b,a);
 	render(GL_POINTS);
 }
 
 void Batch2D::line(float x1, float y1, float x2, float y2, float r, float g, float b, float a){
-	if (index + 6*B2D_VERTEX_SIZE >= capacity)
-		render(GL_TRIANGLES);
+	reserve(2);
 
 	vertex(x1, y1, 0, 0, r,g,b,a);
 	vertex(x2, y2, 1, 1, r,g,b,a);
@@ -96,16 +144,7 @@ void Batch2D::rect(float x, float y, float w, float h){
 	const float g = color.g;
 	const float b = color.b;
 	const float a = color.a;
-	if (index + 6*B2D_VERTEX_SIZE >= capacity)
-		render(GL_TRIANGLES);
-
-	vertex(x, y, 0, 0, r,g,b,a);
-	vertex(x, y+h, 0, 1, r,g,b,a);
-	vertex(x+w, y+h, 1, 1, r,g,b,a);
-
-	vertex(x, y, 0, 0, r,g,b,a);
-	vertex(x+w, y+h, 1, 1, r,g,b,a);
-	vertex(x+w, y, 1, 0, r,g,b,a);
+	quad(x, y, w, h, 0, 0, 1, 1, r,g,b,a);
 }
 
 void Batch2D::rect(
@@ -117,9 +156,6 @@ void Batch2D::rect(
 		bool flippedX,
 		bool flippedY,
 		vec4 tint) {
-	if (index + 6*B2D_VERTEX_SIZE >= capacity)
-		render(GL_TRIANGLES);
-
     float centerX = w*ox;
     float centerY = h*oy;
     float acenterX = w-centerX;
@@ -192,6 +228,11 @@ void Batch2D::rect(
         v3 = temp;
     }
 
+    if (angle == 0) {
+        quad(x1, y1, w, h, u1, v1, u3, v3, tint.r, tint.g, tint.b, tint.a);
+        return;
+    }
+    reserve(6);
     vertex(x1, y1, u1, v1, tint.r, tint.g, tint.b, tint.a);
     vertex(x2, y2, u2, v2, tint.r, tint.g, tint.b, tint.a);
     vertex(x3, y3, u3, v3, tint.r, tint.g, tint.b, tint.a);
@@ -205,15 +246,7 @@ void Batch2D::rect(
 void Batch2D::rect(float x, float y, float w, float h,
 		float u, float v, float tx, float ty,
 		float r, float g, float b, float a){
-	if (index + 6*B2D_VERTEX_SIZE >= capacity)
-		render(GL_TRIANGLES);
-	vertex(x, y, u, v+ty, r,g,b,a);
-	vertex(x+w, y+h, u+tx, v, r,g,b,a);
-	vertex(x, y+h, u, v, r,g,b,a);
-
-	vertex(x, y, u, v+ty, r,g,b,a);
-	vertex(x+w, y, u+tx, v+ty, r,g,b,a);
-	vertex(x+w, y+h, u+tx, v, r,g,b,a);
+	quad(x, y, w, h, u, v+ty, u+tx, v, r,g,b,a);
 }
 
 void Batch2D::rect(float x, float y, float w, float h,
@@ -222,8 +255,7 @@ void Batch2D::rect(float x, float y, float w, float h,
 		float r2, float g2, float b2,
 		float r3, float g3, float b3,
 		float r4, float g4, float b4, int sh){
-	if (index + 30*B2D_VERTEX_SIZE >= capacity)
-		render(GL_TRIANGLES);
+	reserve(30);
 	vec2 v0 = vec2(x+h/2,y+h/2);
 	vec2 v1 = vec2(x+w-sh,y);
 	vec2 v2 = vec2(x+sh,y);
@@ -303,14 +335,45 @@ void Batch2D::sprite(float x, float y, float w, float h, int atlasRes, int index
 	rect(x, y, w, h, u, v, scale, scale, tint.r, tint.g, tint.b, tint.a);
 }
 
+void Batch2D::renderQuads() {
+	if (quadsCount == 0)
+		return;
+	glBindBuffer(GL_ARRAY_BUFFER, quadsVBO);
+	glBufferData(GL_ARRAY_BUFFER, quadsCount * B2D_QUAD_SIZE * sizeof(float), 
+				 quadsBuffer, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	setInstanced(true);
+	glBindVertexArray(quadsVAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, quadsCount);
+	glBindVertexArray(0);
+	flushes++;
+	quads += quadsCount;
+	quadsCount = 0;
+}
+
 void Batch2D::render(unsigned int gl_primitive) {
+    renderQuads();
     if (index == 0)
         return;
+    setInstanced(false);
     mesh->reload(buffer, index / B2D_VERTEX_SIZE);
     mesh->draw(gl_primitive);
+    flushes++;
+    if (gl_primitive == GL_TRIANGLES)
+        quads += index / B2D_VERTEX_SIZE / 6;
     index = 0;
 }
 
+void Batch2D::setInstanced(bool instanced) {
+	GLint program;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	if (program != instancedProgram) {
+		instancedProgram = program;
+		instancedLocation = glGetUniformLocation(program, "u_instanced");
+	}
+	glUniform1i(instancedLocation, instanced);
+}
+
 void Batch2D::render() {
 	render(GL_TRIANGLES);
 }
@@ -318,3 +381,15 @@ void Batch2D::render() {
 void Batch2D::lineWidth(float width) {
 	glLineWidth(width);
 }
+
+size_t Batch2D::flushes = 0;
+size_t Batch2D::quads = 0;
+size_t Batch2D::frameFlushes = 0;
+size_t Batch2D::frameQuads = 0;
+
+void Batch2D::nextFrame() {
+	frameFlushes = flushes;
+	frameQuads = quads;
+	flushes = 0;
+	quads = 0;
+}
@@ -17,6 +17,17 @@ class Batch2D {
 	std::unique_ptr<Mesh> mesh;
 	size_t index;
 
+	/* Axis-aligned quads drawn instanced: one record per quad
+	   (position and size, texture region, color) instead of 6 vertices */
+	float* quadsBuffer;
+	size_t quadsCount;
+	unsigned int quadsVAO;
+	unsigned int quadsVBO;
+	/* u_instanced location of the last used program, 
+	   quads or vertices input is selected by the uniform */
+	int instancedProgram = 0;
+	int instancedLocation = -1;
+
 	Texture* blank;
 	Texture* _texture;
 
@@ -26,10 +37,29 @@ class Batch2D {
 	void vertex(glm::vec2 point,
 			glm::vec2 uvpoint,
 			float r, float g, float b, float a);
+	/* @param u1, v1, u2, v2 texture coords of quad corners
+	   (x, y) and (x+w, y+h) */
+	void quad(float x, float y, float w, float h,
+			float u1, float v1, float u2, float v2,
+			float r, float g, float b, float a);
+	/* Make space for vertices, pending quads are drawn first */
+	void reserve(size_t vertices);
+	void renderQuads();
+	void setInstanced(bool instanced);
 
 public:
 	glm::vec4 color;
 
+	/* Draw calls and quads of the current frame */
+	static size_t flushes;
+	static size_t quads;
+	/* Draw calls and quads of the last frame (debug info) */
+	static size_t frameFlushes;
+	static size_t frameQuads;
+
+	/* Called by engine once per frame */
+	static void nextFrame();
+
 	Batch2D(size_t capacity);
 	~Batch2D();
 
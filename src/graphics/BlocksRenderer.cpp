@@ -1,14 +1,16 @@
 #include "BlocksRenderer.h"
 
+#include <algorithm>
+#include <new>
+#include <string.h>
 #include <glm/glm.hpp>
 
-#include "Mesh.h"
-#include "UVRegion.h"
+#include "ChunkVertex.h"
 #include "../constants.h"
 #include "../content/Content.h"
 #include "../voxels/Block.h"
 #include "../voxels/Chunk.h"
-#include "../voxels/VoxelsVolume.h"
+#include "../voxels/ChunkNeighbourhood.h"
 #include "../voxels/ChunksStorage.h"
 #include "../lighting/Lightmap.h"
 #include "../frontend/ContentGfxCache.h"
@@ -17,9 +19,98 @@ using glm::ivec3;
 using glm::vec3;
 using glm::vec4;
 
-const uint BlocksRenderer::VERTEX_SIZE = 6;
+const uint BlocksRenderer::VERTEX_SIZE = chunk_vertex::SIZE;
 const vec3 BlocksRenderer::SUN_VECTOR (0.411934f, 0.863868f, -0.279161f);
 
+struct GreedyFace {
+	blockid_t id;
+	/* All corners lights are equal, so face may be merged */
+	bool uniform;
+	uint32_t lights[4];
+
+	bool canMerge(const GreedyFace& other) const {
+		return id == other.id && uniform && other.uniform && 
+			   lights[0] == other.lights[0];
+	}
+};
+
+/* Face axes as used by blockCube for non-rotated blocks */
+struct GreedyDirection {
+	ivec3 X, Y, Z;
+	int texface;
+};
+
+static_assert(CHUNK_VOL <= 0x10000, "bucket voxel indices must fit uint16_t");
+
+struct BlockMeshFlag {
+	static const ubyte SOLID = 0x1;
+	static const ubyte LIGHT_PASSING = 0x2;
+	/* Non-rotatable full cube (see greedyCubes) */
+	static const ubyte CUBE = 0x4;
+	/* Neighbour cube face is never visible (see isOpen) */
+	static const ubyte OCCLUDER = 0x8;
+	/* Block makes downsampled cell filled (see buildLodCells) */
+	static const ubyte LOD_FILL = 0x10;
+};
+
+/* Block properties used by mesher, packed to avoid Block lookups */
+struct BlockMeshInfo {
+	ubyte drawGroup;
+	/* Draw group index in rendering order */
+	ubyte bucket;
+	ubyte flags;
+	BlockModel model;
+	/* Faces count upper bound of the block model */
+	uint16_t maxFaces;
+};
+
+static const GreedyDirection GREEDY_DIRECTIONS[6] {
+	{{ 1, 0, 0}, {0, 1, 0}, { 0, 0, 1}, 5}, // north
+	{{-1, 0, 0}, {0, 1, 0}, { 0, 0,-1}, 4}, // south
+	{{ 1, 0, 0}, {0, 0,-1}, { 0, 1, 0}, 3}, // top
+	{{ 1, 0, 0}, {0, 0, 1}, { 0,-1, 0}, 2}, // bottom
+	{{ 0, 0,-1}, {0, 1, 0}, { 1, 0, 0}, 1}, // west
+	{{ 0, 0, 1}, {0, 1, 0}, {-1, 0, 0}, 0}, // east
+};
+
+/* Spread 4-bit light channels to bytes: r | g << 8 | b << 16 | s << 24 */
+static inline uint32_t unpack_light(light_t light) {
+	uint32_t value = (light & 0xFFu) | (light & 0xFF00u) << 8;
+	return (value & 0x000F000Fu) | (value & 0x00F000F0u) << 4;
+}
+
+/* Add bias (0 or 1 per channel) to the unpacked light, but not above 15 */
+static inline uint32_t add_light_bias(uint32_t light, uint32_t bias) {
+	light += bias;
+	return light - ((light >> 4) & 0x01010101u);
+}
+
+static inline uint32_t compress_light(const vec4& light) {
+	uint32_t compressed = (uint32_t(light.r * 255) & 0xff) << 24;
+	compressed |= (uint32_t(light.g * 255) & 0xff) << 16;
+	compressed |= (uint32_t(light.b * 255) & 0xff) << 8;
+	compressed |= (uint32_t(light.a * 255) & 0xff);
+	return compressed;
+}
+
+/* Compress sum of unpacked light samples divided by max multiplied 
+   by tint without vec4 conversion, same result as compress_light
+   @param max 15 * samples count (60 for soft light, see sampleSoftLight) */
+static inline uint32_t compress_light_sum(uint32_t sum, float max, float tint) {
+	uint32_t compressed = (uint32_t((sum & 0xFF) / max * tint * 255) & 0xff) << 24;
+	compressed |= (uint32_t(((sum >> 8) & 0xFF) / max * tint * 255) & 0xff) << 16;
+	compressed |= (uint32_t(((sum >> 16) & 0xFF) / max * tint * 255) & 0xff) << 8;
+	compressed |= (uint32_t((sum >> 24) / max * tint * 255) & 0xff);
+	return compressed;
+}
+
+static inline uint32_t count_bits(uint32_t value) {
+	value = value - ((value >> 1) & 0x55555555u);
+	value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+	value = (value + (value >> 4)) & 0x0F0F0F0Fu;
+	return (value * 0x01010101u) >> 24;
+}
+
 BlocksRenderer::BlocksRenderer(size_t capacity,
 	const Content* content,
 	const ContentGfxCache* cache,
@@ -31,38 +122,100 @@ BlocksRenderer::BlocksRenderer(size_t capacity,
 	capacity(capacity),
 	cache(cache),
 	settings(settings) {
-	vertexBuffer = new float[capacity];
-	indexBuffer = new int[capacity];
-	voxelsBuffer = new VoxelsVolume(CHUNK_W + 2, CHUNK_H, CHUNK_D + 2);
+	vertexBuffer = new uint32_t[capacity * 4 * VERTEX_SIZE];
+	indexBuffer = new int[capacity * 6];
+	neighbourhood = new ChunkNeighbourhood();
+	greedyMask = new GreedyFace[CHUNK_H * std::max(CHUNK_W, CHUNK_D)];
 	blockDefsCache = content->getIndices()->getBlockDefs();
+
+	drawGroups.assign(content->drawGroups->begin(), content->drawGroups->end());
+	buckets.resize(drawGroups.size());
+	size_t count = content->getIndices()->countBlockDefs();
+	blockInfo = new BlockMeshInfo[count];
+	for (size_t i = 0; i < count; i++) {
+		const Block& def = *blockDefsCache[i];
+		BlockMeshInfo& info = blockInfo[i];
+		info.drawGroup = def.drawGroup;
+		info.bucket = std::find(drawGroups.begin(), drawGroups.end(), def.drawGroup) - drawGroups.begin();
+		info.flags = 0;
+		if (def.rt.solid)
+			info.flags |= BlockMeshFlag::SOLID;
+		if (def.lightPassing)
+			info.flags |= BlockMeshFlag::LIGHT_PASSING;
+		if (def.model == BlockModel::block && !def.rotatable)
+			info.flags |= BlockMeshFlag::CUBE;
+		if (def.rt.solid && !def.lightPassing)
+			info.flags |= BlockMeshFlag::OCCLUDER;
+		if (def.model == BlockModel::block || (info.flags & BlockMeshFlag::OCCLUDER))
+			info.flags |= BlockMeshFlag::LOD_FILL;
+		info.model = def.model;
+		switch (def.model) {
+		case BlockModel::block:
+		case BlockModel::aabb:
+			info.maxFaces = 6;
+			break;
+		case BlockModel::xsprite:
+			info.maxFaces = 4;
+			break;
+		case BlockModel::custom:
+			info.maxFaces = def.modelBoxes.size() * 6 + def.modelExtraPoints.size() / 4;
+			break;
+		default:
+			info.maxFaces = 0;
+			break;
+		}
+	}
 }
 
 BlocksRenderer::~BlocksRenderer() {
-	delete voxelsBuffer;
+	delete neighbourhood;
+	delete[] blockInfo;
+	delete[] greedyMask;
 	delete[] vertexBuffer;
 	delete[] indexBuffer;
 }
 
-/* Basic vertex add method */
-void BlocksRenderer::vertex(const vec3& coord, float u, float v, const vec4& light) {
-	vertexBuffer[vertexOffset++] = coord.x;
-	vertexBuffer[vertexOffset++] = coord.y;
-	vertexBuffer[vertexOffset++] = coord.z;
-
-	vertexBuffer[vertexOffset++] = u;
-	vertexBuffer[vertexOffset++] = v;
+inline bool BlocksRenderer::reserveFace() {
+	if (indexSize + 6 <= capacity * 6)
+		return true;
+	// estimate is an upper bound, so it should never happen
+	overflow = true;
+	return reserve(std::max(capacity * 2, indexSize / 6 + 1));
+}
 
-	union {
-		float floating;
-		uint32_t integer;
-	} compressed;
+bool BlocksRenderer::reserve(size_t faces) {
+	if (faces <= capacity)
+		return true;
+	uint32_t* newVertexBuffer = nullptr;
+	int* newIndexBuffer = nullptr;
+	try {
+		newVertexBuffer = new uint32_t[faces * 4 * VERTEX_SIZE];
+		newIndexBuffer = new int[faces * 6];
+	} catch (const std::bad_alloc&) {
+		delete[] newVertexBuffer;
+		truncated = true;
+		return false;
+	}
+	memcpy(newVertexBuffer, vertexBuffer, vertexOffset * sizeof(uint32_t));
+	memcpy(newIndexBuffer, indexBuffer, indexSize * sizeof(int));
+	delete[] vertexBuffer;
+	delete[] indexBuffer;
+	vertexBuffer = newVertexBuffer;
+	indexBuffer = newIndexBuffer;
+	capacity = faces;
+	return true;
+}
 
-	compressed.integer = (uint32_t(light.r * 255) & 0xff) << 24;
-	compressed.integer |= (uint32_t(light.g * 255) & 0xff) << 16;
-	compressed.integer |= (uint32_t(light.b * 255) & 0xff) << 8;
-	compressed.integer |= (uint32_t(light.a * 255) & 0xff);
+/* Basic vertex add method */
+void BlocksRenderer::vertex(const vec3& coord, uint u, uint v, 
+							uint32_t light, regionid_t region) {
+	chunk_vertex::pack(vertexBuffer + vertexOffset, coord, u, v, region, light);
+	vertexOffset += chunk_vertex::SIZE;
+}
 
-	vertexBuffer[vertexOffset++] = compressed.floating;
+void BlocksRenderer::vertex(const vec3& coord, uint u, uint v, 
+							const vec4& light, regionid_t region) {
+	vertex(coord, u, v, compress_light(light), region);
 }
 
 void BlocksRenderer::index(int a, int b, int c, int d, int e, int f) {
@@ -81,66 +234,64 @@ void BlocksRenderer::face(const vec3& coord,
 						  const vec3& axisX,
 						  const vec3& axisY,
                           const vec3& axisZ,
-						  const UVRegion& region,
+						  regionid_t region,
 						  const vec4(&lights)[4],
 						  const vec4& tint) {
-	if (vertexOffset + BlocksRenderer::VERTEX_SIZE * 4 > capacity) {
-		overflow = true;
+	if (!reserveFace())
 		return;
-	}
     vec3 X = axisX * w;
     vec3 Y = axisY * h;
     vec3 Z = axisZ * d;
     float s = 0.5f;
-	vertex(coord + (-X - Y + Z) * s, region.u1, region.v1, lights[0] * tint);
-	vertex(coord + ( X - Y + Z) * s, region.u2, region.v1, lights[1] * tint);
-	vertex(coord + ( X + Y + Z) * s, region.u2, region.v2, lights[2] * tint);
-	vertex(coord + (-X + Y + Z) * s, region.u1, region.v2, lights[3] * tint);
+	vertex(coord + (-X - Y + Z) * s, 0, 0, lights[0] * tint, region);
+	vertex(coord + ( X - Y + Z) * s, 1, 0, lights[1] * tint, region);
+	vertex(coord + ( X + Y + Z) * s, 1, 1, lights[2] * tint, region);
+	vertex(coord + (-X + Y + Z) * s, 0, 1, lights[3] * tint, region);
 	index(0, 1, 3, 1, 2, 3);
 }
 
-void BlocksRenderer::vertex(const vec3& coord, 
-							float u, float v,
-							const vec4& tint,
-							const vec3& X,
-							const vec3& Y,
-							const vec3& Z) {
-    // TODO: optimize
-    vec3 axisX = glm::normalize(X);
-    vec3 axisY = glm::normalize(Y);
-    vec3 axisZ = glm::normalize(Z);
-    vec3 pos = coord+axisZ*0.5f+(axisX+axisY)*0.5f;
-	vec4 light = pickSoftLight(ivec3(round(pos.x), round(pos.y), round(pos.z)), axisX, axisY);
-	vertex(coord, u, v, light * tint);
-}
-
 void BlocksRenderer::face(const vec3& coord,
 						  const vec3& X,
 						  const vec3& Y,
 						  const vec3& Z,
-						  const UVRegion& region,
+						  regionid_t region,
                           bool lights) {
-	if (vertexOffset + BlocksRenderer::VERTEX_SIZE * 4 > capacity) {
-		overflow = true;
+	if (!reserveFace())
 		return;
-	}
 
     float s = 0.5f;
     if (lights) {
         float d = glm::dot(Z, SUN_VECTOR);
         d = 0.8f + d * 0.2f;
 
-        vec4 tint(d);
-        vertex(coord + (-X - Y + Z) * s, region.u1, region.v1, tint, X, Y, Z);
-        vertex(coord + ( X - Y + Z) * s, region.u2, region.v1, tint, X, Y, Z);
-        vertex(coord + ( X + Y + Z) * s, region.u2, region.v2, tint, X, Y, Z);
-        vertex(coord + (-X + Y + Z) * s, region.u1, region.v2, tint, X, Y, Z);
+        // face axes are axis aligned, so normalized axes are their signs
+        const ivec3 right (glm::sign(X));
+        const ivec3 up (glm::sign(Y));
+        // corner light is sampled in front of the vertex
+        const vec3 front = glm::sign(Z) * 0.5f;
+        const vec3 side = vec3(right + up) * 0.5f;
+        const vec3 corners[4] {
+            coord + (-X - Y + Z) * s,
+            coord + ( X - Y + Z) * s,
+            coord + ( X + Y + Z) * s,
+            coord + (-X + Y + Z) * s
+        };
+        uint32_t lights[4];
+        for (int i = 0; i < 4; i++) {
+            const vec3 pos = corners[i] + front + side;
+            const ivec3 icoord (std::round(pos.x), std::round(pos.y), std::round(pos.z));
+            lights[i] = compress_light_sum(sampleSoftLight(icoord, right, up), 60.0f, d);
+        }
+        vertex(corners[0], 0, 0, lights[0], region);
+        vertex(corners[1], 1, 0, lights[1], region);
+        vertex(corners[2], 1, 1, lights[2], region);
+        vertex(corners[3], 0, 1, lights[3], region);
     } else {
         vec4 tint(1.0f);
-        vertex(coord + (-X - Y + Z) * s, region.u1, region.v1, tint);
-        vertex(coord + ( X - Y + Z) * s, region.u2, region.v1, tint);
-        vertex(coord + ( X + Y + Z) * s, region.u2, region.v2, tint);
-        vertex(coord + (-X + Y + Z) * s, region.u1, region.v2, tint);
+        vertex(coord + (-X - Y + Z) * s, 0, 0, tint, region);
+        vertex(coord + ( X - Y + Z) * s, 1, 0, tint, region);
+        vertex(coord + ( X + Y + Z) * s, 1, 1, tint, region);
+        vertex(coord + (-X + Y + Z) * s, 0, 1, tint, region);
     }
 	index(0, 1, 2, 0, 2, 3);
 }
@@ -150,9 +301,11 @@ void BlocksRenderer::tetragonicFace(const vec3& coord, const vec3& p1,
 									const vec3& X,
 									const vec3& Y,
 									const vec3& Z,
-									const UVRegion& texreg,
+									regionid_t texreg,
 									bool lights) {
-    
+	if (!reserveFace())
+		return;
+
     const vec3 fp1 = (p1.x - 0.5f) * X + (p1.y - 0.5f) * Y + (p1.z - 0.5f) * Z;
     const vec3 fp2 = (p2.x - 0.5f) * X + (p2.y - 0.5f) * Y + (p2.z - 0.5f) * Z;
     const vec3 fp3 = (p3.x - 0.5f) * X + (p3.y - 0.5f) * Y + (p3.z - 0.5f) * Z;
@@ -172,17 +325,17 @@ void BlocksRenderer::tetragonicFace(const vec3& coord, const vec3& p1,
         // tint.y = normal.y * 0.5f + 0.5f;
         // tint.z = normal.z * 0.5f + 0.5f;
     }
-	vertex(coord + fp1, texreg.u1, texreg.v1, tint);
-	vertex(coord + fp2, texreg.u2, texreg.v1, tint);
-	vertex(coord + fp3, texreg.u2, texreg.v2, tint);
-	vertex(coord + fp4, texreg.u1, texreg.v2, tint);
+	vertex(coord + fp1, 0, 0, tint, texreg);
+	vertex(coord + fp2, 1, 0, tint, texreg);
+	vertex(coord + fp3, 1, 1, tint, texreg);
+	vertex(coord + fp4, 0, 1, tint, texreg);
 	index(0, 1, 3, 1, 2, 3);
 }
 
 void BlocksRenderer::blockXSprite(int x, int y, int z, 
 								  const vec3& size, 
-								  const UVRegion& texface1, 
-								  const UVRegion& texface2, 
+								  regionid_t texface1, 
+								  regionid_t texface2, 
 								  float spread) {
 	vec4 lights[]{
 			pickSoftLight({x, y + 1, z}, {1, 0, 0}, {0, 1, 0}),
@@ -217,7 +370,7 @@ void BlocksRenderer::blockXSprite(int x, int y, int z,
 
 /* AABB blocks render method */
 void BlocksRenderer::blockAABB(const ivec3& icoord,
-							   const UVRegion(&texfaces)[6], 
+							   const regionid_t(&texfaces)[6], 
 							   const Block* block, ubyte rotation,
                                bool lights) {
 	AABB hitbox = block->hitbox;
@@ -270,12 +423,12 @@ void BlocksRenderer::blockCustomModel(const ivec3& icoord,
 			orient.transform(box);
 		}
 		vec3 center_coord = coord - vec3(0.5f) + box.center();
-		face(center_coord, X * size.x, Y * size.y, Z * size.z, block->modelUVs[i * 6 + 5], lights); // north
-		face(center_coord, -X * size.x, Y * size.y, -Z * size.z, block->modelUVs[i * 6 + 4], lights); // south
-		face(center_coord, X * size.x, -Z * size.z, Y * size.y, block->modelUVs[i * 6 + 3], lights); // top
-		face(center_coord, -X * size.x, -Z * size.z, -Y * size.y, block->modelUVs[i * 6 + 2], lights); // bottom
-		face(center_coord, -Z * size.z, Y * size.y, X * size.x, block->modelUVs[i * 6 + 1], lights); // west
-		face(center_coord, Z * size.z, Y * size.y, -X * size.x, block->modelUVs[i * 6 + 0], lights); // east
+		face(center_coord, X * size.x, Y * size.y, Z * size.z, cache->getModelRegionIndex(block->rt.id, i * 6 + 5), lights); // north
+		face(center_coord, -X * size.x, Y * size.y, -Z * size.z, cache->getModelRegionIndex(block->rt.id, i * 6 + 4), lights); // south
+		face(center_coord, X * size.x, -Z * size.z, Y * size.y, cache->getModelRegionIndex(block->rt.id, i * 6 + 3), lights); // top
+		face(center_coord, -X * size.x, -Z * size.z, -Y * size.y, cache->getModelRegionIndex(block->rt.id, i * 6 + 2), lights); // bottom
+		face(center_coord, -Z * size.z, Y * size.y, X * size.x, cache->getModelRegionIndex(block->rt.id, i * 6 + 1), lights); // west
+		face(center_coord, Z * size.z, Y * size.y, -X * size.x, cache->getModelRegionIndex(block->rt.id, i * 6 + 0), lights); // east
 	}
 	
 	for (size_t i = 0; i < block->modelExtraPoints.size()/4; i++) {
@@ -285,13 +438,13 @@ void BlocksRenderer::blockCustomModel(const ivec3& icoord,
 			block->modelExtraPoints[i * 4 + 2],
 			block->modelExtraPoints[i * 4 + 3],
 			X, Y, Z,
-			block->modelUVs[block->modelBoxes.size()*6 + i], lights);
+			cache->getModelRegionIndex(block->rt.id, block->modelBoxes.size()*6 + i), lights);
 	}
 }
 
 /* Fastest solid shaded blocks render method */
 void BlocksRenderer::blockCube(int x, int y, int z, 
-									 const UVRegion(&texfaces)[6], 
+									 const regionid_t(&texfaces)[6], 
 									 const Block* block, 
 									 ubyte states,
                                      bool lights) {
@@ -329,46 +482,317 @@ void BlocksRenderer::blockCube(int x, int y, int z,
 	}
 }
 
+void BlocksRenderer::greedyCubes(ubyte drawGroup, const voxel* voxels) {
+	const int offset[3] {0, bottom, 0};
+	const int size[3] {CHUNK_W, top - bottom, CHUNK_D};
+
+	for (const auto& dir : GREEDY_DIRECTIONS) {
+		const ivec3& X = dir.X;
+		const ivec3& Y = dir.Y;
+		const ivec3& Z = dir.Z;
+		// axes indices: n - normal, a - face width, b - face height
+		const int n = Z.x ? 0 : (Z.y ? 1 : 2);
+		const int a = X.x ? 0 : (X.y ? 1 : 2);
+		const int b = Y.x ? 0 : (Y.y ? 1 : 2);
+		const int maskW = size[a];
+		const int maskH = size[b];
+		vec3 unitA(0.0f), unitB(0.0f);
+		unitA[a] = 1.0f;
+		unitB[b] = 1.0f;
+		const float d = 0.8f + glm::dot(vec3(Z), SUN_VECTOR) * 0.2f;
+
+		// chunk voxels index steps along x, y, z
+		const int strides[3] {1, CHUNK_W * CHUNK_D, CHUNK_W};
+		const int frontStep = Z.x * strides[0] + Z.y * strides[1] + Z.z * strides[2];
+
+		for (int slice = 0; slice < size[n]; slice++) {
+			// faces looking out of the volume are never visible
+			const int frontN = offset[n] + slice + Z[n];
+			if (n == 1 && (frontN < 0 || frontN >= CHUNK_H))
+				continue;
+			// front voxels of the slice are in the neighbour chunk
+			const bool frontOutside = n != 1 && 
+				(frontN < 0 || frontN >= (n == 0 ? CHUNK_W : CHUNK_D));
+			int faces = 0;
+			for (int j = 0; j < maskH; j++) {
+				int index = (offset[n] + slice) * strides[n] + 
+							(offset[b] + j) * strides[b] + 
+							offset[a] * strides[a];
+				for (int i = 0; i < maskW; i++, index += strides[a]) {
+					GreedyFace& face = greedyMask[j * maskW + i];
+					face.id = 0;
+					const blockid_t id = voxels[index].id;
+					if (id == 0)
+						continue;
+					const BlockMeshInfo& info = blockInfo[id];
+					if (info.drawGroup != drawGroup || !(info.flags & BlockMeshFlag::CUBE))
+						continue;
+					blockid_t frontId;
+					if (frontOutside) {
+						ivec3 front;
+						front[n] = frontN;
+						front[a] = offset[a] + i;
+						front[b] = offset[b] + j;
+						frontId = neighbourhood->pickBlockId(front.x, front.y, front.z);
+					} else {
+						frontId = voxels[index + frontStep].id;
+					}
+					if (!isOpen(frontId, drawGroup))
+						continue;
+					face.id = id;
+					faces++;
+					if (blockDefsCache[id]->rt.emissive) {
+						face.lights[0] = face.lights[1] = face.lights[2] = face.lights[3] = 
+							compress_light(vec4(1.0f));
+						face.uniform = true;
+						continue;
+					}
+					ivec3 pos;
+					pos[n] = offset[n] + slice;
+					pos[a] = offset[a] + i;
+					pos[b] = offset[b] + j;
+					// same corners as picked by vertex(..., X, Y, Z)
+					const ivec3 front = pos + Z;
+					face.lights[0] = compress_light_sum(sampleSoftLight(front, X, Y), 60.0f, d);
+					face.lights[1] = compress_light_sum(sampleSoftLight(front + X, X, Y), 60.0f, d);
+					face.lights[2] = compress_light_sum(sampleSoftLight(front + X + Y, X, Y), 60.0f, d);
+					face.lights[3] = compress_light_sum(sampleSoftLight(front + Y, X, Y), 60.0f, d);
+					face.uniform = face.lights[0] == face.lights[1] &&
+								   face.lights[0] == face.lights[2] &&
+								   face.lights[0] == face.lights[3];
+				}
+			}
+			if (faces == 0)
+				continue;
+
+			for (int j = 0; j < maskH; j++) {
+				for (int i = 0; i < maskW; i++) {
+					const GreedyFace face = greedyMask[j * maskW + i];
+					if (face.id == 0)
+						continue;
+					int w = 1;
+					int h = 1;
+					while (i + w < maskW && w < int(chunk_vertex::MAX_TILES) && face.canMerge(greedyMask[j * maskW + i + w])) {
+						w++;
+					}
+					for (bool expand = face.uniform; expand && j + h < maskH && h < int(chunk_vertex::MAX_TILES); ) {
+						for (int k = 0; k < w; k++) {
+							if (!face.canMerge(greedyMask[(j + h) * maskW + i + k])) {
+								expand = false;
+								break;
+							}
+						}
+						if (expand) {
+							h++;
+						}
+					}
+					for (int y = 0; y < h; y++) {
+						for (int x = 0; x < w; x++) {
+							greedyMask[(j + y) * maskW + i + x].id = 0;
+						}
+					}
+
+					if (!reserveFace())
+						return;
+					vec3 coord;
+					coord[n] = offset[n] + slice;
+					coord[a] = offset[a] + i;
+					coord[b] = offset[b] + j;
+					coord += unitA * ((w - 1) * 0.5f) + unitB * ((h - 1) * 0.5f);
+
+					const regionid_t region = cache->getRegionIndex(face.id, dir.texface);
+					const vec3 fx = vec3(X) * float(w);
+					const vec3 fy = vec3(Y) * float(h);
+					const vec3 fz = vec3(Z);
+					const float s = 0.5f;
+					vertex(coord + (-fx - fy + fz) * s, 0, 0, face.lights[0], region);
+					vertex(coord + ( fx - fy + fz) * s, w, 0, face.lights[1], region);
+					vertex(coord + ( fx + fy + fz) * s, w, h, face.lights[2], region);
+					vertex(coord + (-fx + fy + fz) * s, 0, h, face.lights[3], region);
+					index(0, 1, 2, 0, 2, 3);
+				}
+			}
+		}
+	}
+}
+
+blockid_t BlocksRenderer::pickLodBlock(const voxel* voxels, const ivec3& origin, int scale) const {
+	// top voxels first to keep look of the surface
+	for (int y = origin.y + scale - 1; y >= origin.y; y--) {
+		for (int z = origin.z; z < origin.z + scale; z++) {
+			const voxel* row = voxels + vox_index(origin.x, y, z);
+			for (int x = 0; x < scale; x++) {
+				blockid_t id = row[x].id;
+				if (blockInfo[id].flags & BlockMeshFlag::LOD_FILL)
+					return id;
+			}
+		}
+	}
+	return 0;
+}
+
+void BlocksRenderer::buildLodCells(int scale) {
+	const int width = CHUNK_W / scale;
+	const int depth = CHUNK_D / scale;
+	const voxel* voxels = neighbourhood->getVoxels();
+	// cells out of bottom..top range are air
+	lodCells.assign(width * (CHUNK_H / scale) * depth, 0);
+	for (int cy = chunkBottom / scale; cy * scale < chunkTop; cy++) {
+		for (int cz = 0; cz < depth; cz++) {
+			for (int cx = 0; cx < width; cx++) {
+				lodCells[(cy * depth + cz) * width + cx] = 
+					pickLodBlock(voxels, ivec3(cx, cy, cz) * scale, scale);
+			}
+		}
+	}
+}
+
+bool BlocksRenderer::sampleLodLayer(const ivec3& origin, 
+									const ivec3& right, 
+									const ivec3& up, 
+									int scale,
+									float tint,
+									uint32_t& light) const {
+	bool closed = true;
+	uint32_t sum = 0;
+	int samples = 0;
+	for (int j = 0; j < scale; j++) {
+		for (int i = 0; i < scale; i++) {
+			const ivec3 coord = origin + right * i + up * j;
+			blockid_t id = neighbourhood->pickBlockId(coord.x, coord.y, coord.z);
+			if (id == BLOCK_VOID)
+				continue;
+			const ubyte flags = blockInfo[id].flags;
+			if (!(flags & BlockMeshFlag::OCCLUDER))
+				closed = false;
+			if (id == 0 || (flags & BlockMeshFlag::LIGHT_PASSING)) {
+				sum += sampleLight(coord);
+				samples++;
+			}
+		}
+	}
+	light = compress_light_sum(sum, 15.0f * std::max(samples, 1), tint);
+	return !closed;
+}
+
+void BlocksRenderer::renderLod(int scale) {
+	const int width = CHUNK_W / scale;
+	const int height = CHUNK_H / scale;
+	const int depth = CHUNK_D / scale;
+	for (int cy = bottom / scale; cy * scale < top; cy++) {
+		for (int cz = 0; cz < depth; cz++) {
+			for (int cx = 0; cx < width; cx++) {
+				blockid_t id = lodCells[(cy * depth + cz) * width + cx];
+				if (id == 0)
+					continue;
+				const bool lights = !blockDefsCache[id]->rt.emissive;
+				const ivec3 origin = ivec3(cx, cy, cz) * scale;
+				const vec3 center = vec3(origin) + (scale - 1) * 0.5f;
+				for (const auto& dir : GREEDY_DIRECTIONS) {
+					const ivec3 ncell = ivec3(cx, cy, cz) + dir.Z;
+					if (ncell.y < 0 || ncell.y >= height)
+						continue;
+					const bool inside = ncell.x >= 0 && ncell.x < width && 
+										ncell.z >= 0 && ncell.z < depth;
+					if (inside && lodCells[(ncell.y * depth + ncell.z) * width + ncell.x])
+						continue;
+					// voxels layer in front of the face
+					const ivec3 right = glm::abs(dir.X);
+					const ivec3 up = glm::abs(dir.Y);
+					const ivec3 layer = origin + glm::max(dir.Z, ivec3(0)) * scale + glm::min(dir.Z, ivec3(0));
+					const float d = 0.8f + glm::dot(vec3(dir.Z), SUN_VECTOR) * 0.2f;
+					uint32_t light;
+					// other chunks voxels are not downsampled here, so the face
+					// is hidden only if it is closed by them
+					if (!sampleLodLayer(layer, right, up, scale, d, light) && !inside)
+						continue;
+					if (!lights) {
+						light = compress_light(vec4(1.0f));
+					}
+					if (!reserveFace())
+						return;
+					const regionid_t region = cache->getRegionIndex(id, dir.texface);
+					const vec3 fx = vec3(dir.X) * float(scale);
+					const vec3 fy = vec3(dir.Y) * float(scale);
+					const vec3 fz = vec3(dir.Z) * float(scale);
+					const float s = 0.5f;
+					vertex(center + (-fx - fy + fz) * s, 0, 0, light, region);
+					vertex(center + ( fx - fy + fz) * s, scale, 0, light, region);
+					vertex(center + ( fx + fy + fz) * s, scale, scale, light, region);
+					vertex(center + (-fx + fy + fz) * s, 0, scale, light, region);
+					index(0, 1, 2, 0, 2, 3);
+				}
+			}
+		}
+	}
+}
+
 // Does block allow to see other blocks sides (is it transparent)
 bool BlocksRenderer::isOpen(int x, int y, int z, ubyte group) const {
-	blockid_t id = voxelsBuffer->pickBlockId(chunk->x * CHUNK_W + x, 
-											 y, 
-											 chunk->z * CHUNK_D + z);
+	return isOpen(neighbourhood->pickBlockId(x, y, z), group);
+}
+
+bool BlocksRenderer::isOpen(blockid_t id, ubyte group) const {
 	if (id == BLOCK_VOID)
 		return false;
-	const Block& block = *blockDefsCache[id];
-	if ((block.drawGroup != group && block.lightPassing) || !block.rt.solid) {
+	const BlockMeshInfo& info = blockInfo[id];
+	if ((info.drawGroup != group && (info.flags & BlockMeshFlag::LIGHT_PASSING)) || 
+		!(info.flags & BlockMeshFlag::SOLID)) {
 		return true;
 	}
 	return !id;
 }
 
 bool BlocksRenderer::isOpenForLight(int x, int y, int z) const {
-	blockid_t id = voxelsBuffer->pickBlockId(chunk->x * CHUNK_W + x, 
-											 y, 
-											 chunk->z * CHUNK_D + z);
+	blockid_t id = neighbourhood->pickBlockId(x, y, z);
 	if (id == BLOCK_VOID)
 		return false;
-	const Block& block = *blockDefsCache[id];
-	if (block.lightPassing) {
+	if (blockInfo[id].flags & BlockMeshFlag::LIGHT_PASSING) {
 		return true;
 	}
 	return !id;
 }
 
-vec4 BlocksRenderer::pickLight(int x, int y, int z) const {
-	if (isOpenForLight(x, y, z)) {
-		light_t light = voxelsBuffer->pickLight(chunk->x * CHUNK_W + x, 
-												y, 
-												chunk->z * CHUNK_D + z);
-		return vec4(Lightmap::extract(light, 0) / 15.0f,
-			Lightmap::extract(light, 1) / 15.0f,
-			Lightmap::extract(light, 2) / 15.0f,
-			Lightmap::extract(light, 3) / 15.0f);
-	}
-	else {
-		return vec4(0.0f);
+inline uint32_t BlocksRenderer::sampleLight(uint index) const {
+	blockid_t id = neighbourhood->getVoxels()[index].id;
+	// branchless: samples are mostly unpredictable
+	uint32_t open = (id == 0) | (blockInfo[id].flags & BlockMeshFlag::LIGHT_PASSING);
+	uint32_t light = unpack_light(neighbourhood->getLights()[index]);
+	return add_light_bias(light, lightBias) & -uint32_t(open != 0);
+}
+
+uint32_t BlocksRenderer::sampleLight(const ivec3& coord) const {
+	if (!isOpenForLight(coord.x, coord.y, coord.z))
+		return 0;
+	uint32_t light = unpack_light(neighbourhood->pickLight(coord.x, coord.y, coord.z));
+	return add_light_bias(light, lightBias);
+}
+
+uint32_t BlocksRenderer::sampleSoftLight(const ivec3& coord, 
+										 const ivec3& right, 
+										 const ivec3& up) const {
+	const int fx = coord.x - right.x - up.x;
+	const int fy = coord.y - right.y - up.y;
+	const int fz = coord.z - right.z - up.z;
+	if (std::min(coord.x, fx) < 0 || std::max(coord.x, fx) >= CHUNK_W ||
+		std::min(coord.y, fy) < 0 || std::max(coord.y, fy) >= CHUNK_H ||
+		std::min(coord.z, fz) < 0 || std::max(coord.z, fz) >= CHUNK_D) {
+		return sampleLight(coord) + sampleLight(coord - right) + 
+			   sampleLight(coord - right - up) + sampleLight(coord - up);
 	}
+	// all samples are in the chunk: voxel index offsets are used
+	const uint index = vox_index(coord.x, coord.y, coord.z);
+	const int rightStep = (right.y * CHUNK_D + right.z) * CHUNK_W + right.x;
+	const int upStep = (up.y * CHUNK_D + up.z) * CHUNK_W + up.x;
+	return sampleLight(index) + 
+		   sampleLight(index - rightStep) + 
+		   sampleLight(index - rightStep - upStep) + 
+		   sampleLight(index - upStep);
+}
+
+vec4 BlocksRenderer::pickLight(int x, int y, int z) const {
+	uint32_t light = sampleLight(ivec3(x, y, z));
+	return vec4(light & 0xFF, (light >> 8) & 0xFF, (light >> 16) & 0xFF, light >> 24) / 15.0f;
 }
 
 vec4 BlocksRenderer::pickLight(const ivec3& coord) const {
@@ -378,41 +802,52 @@ vec4 BlocksRenderer::pickLight(const ivec3& coord) const {
 vec4 BlocksRenderer::pickSoftLight(const ivec3& coord, 
 								   const ivec3& right, 
 								   const ivec3& up) const {
-	return (
-		pickLight(coord) +
-		pickLight(coord - right) +
-		pickLight(coord - right - up) +
-		pickLight(coord - up)) * 0.25f;
-}
-
-vec4 BlocksRenderer::pickSoftLight(float x, float y, float z, 
-								  const ivec3& right, 
-								  const ivec3& up) const {
-	return pickSoftLight({int(round(x)), int(round(y)), int(round(z))}, right, up);
+	uint32_t light = sampleSoftLight(coord, right, up);
+	return vec4(light & 0xFF, (light >> 8) & 0xFF, (light >> 16) & 0xFF, light >> 24) / 60.0f;
 }
 
 void BlocksRenderer::render(const voxel* voxels) {
-	int begin = chunk->bottom * (CHUNK_W * CHUNK_D);
-	int end = chunk->top * (CHUNK_W * CHUNK_D);
-	for (const auto drawGroup : *content->drawGroups) {
-		for (int i = begin; i < end; i++) {
-			const voxel& vox = voxels[i];
+	for (auto& bucket : buckets) {
+		bucket.voxels.clear();
+		bucket.greedy = false;
+	}
+	const uint end = vox_index(0, top, 0);
+	for (uint index = vox_index(0, bottom, 0); index < end; index++) {
+		blockid_t id = voxels[index].id;
+		const BlockMeshInfo& info = blockInfo[id];
+		if (id == 0 || info.model == BlockModel::none)
+			continue;
+		DrawGroupBucket& bucket = buckets[info.bucket];
+		if (greedy && (info.flags & BlockMeshFlag::CUBE)) {
+			bucket.greedy = true;
+		} else {
+			bucket.voxels.push_back(index);
+		}
+	}
+
+	for (size_t i = 0; i < buckets.size(); i++) {
+		const DrawGroupBucket& bucket = buckets[i];
+		if (bucket.greedy) {
+			greedyCubes(drawGroups[i], voxels);
+			if (truncated)
+				return;
+		}
+		for (uint16_t index : bucket.voxels) {
+			const int x = index % CHUNK_W;
+			const int z = index / CHUNK_W % CHUNK_D;
+			const int y = index / (CHUNK_W * CHUNK_D);
+			const voxel& vox = voxels[index];
 			blockid_t id = vox.id;
 			const Block& def = *blockDefsCache[id];
-			if (id == 0 || def.drawGroup != drawGroup)
-				continue;
-			const UVRegion texfaces[6]{ cache->getRegion(id, 0), 
-										cache->getRegion(id, 1),
-										cache->getRegion(id, 2), 
-										cache->getRegion(id, 3),
-										cache->getRegion(id, 4), 
-										cache->getRegion(id, 5)};
-			int x = i % CHUNK_W;
-			int y = i / (CHUNK_D * CHUNK_W);
-			int z = (i / CHUNK_D) % CHUNK_W;
+			const regionid_t texfaces[6]{ cache->getRegionIndex(id, 0), 
+										  cache->getRegionIndex(id, 1),
+										  cache->getRegionIndex(id, 2), 
+										  cache->getRegionIndex(id, 3),
+										  cache->getRegionIndex(id, 4), 
+										  cache->getRegionIndex(id, 5)};
 			switch (def.model) {
 			case BlockModel::block:
-                blockCube(x, y, z, texfaces, &def, vox.states, !def.rt.emissive);
+				blockCube(x, y, z, texfaces, &def, vox.states, !def.rt.emissive);
 				break;
 			case BlockModel::xsprite: {
 				blockXSprite(x, y, z, vec3(1.0f), 
@@ -430,28 +865,191 @@ void BlocksRenderer::render(const voxel* voxels) {
 			default:
 				break;
 			}
-			if (overflow)
+			if (truncated)
 				return;
 		}
 	}
 }
 
-Mesh* BlocksRenderer::render(const Chunk* chunk, const ChunksStorage* chunks) {
-	this->chunk = chunk;
-	voxelsBuffer->setPosition(chunk->x * CHUNK_W - 1, 0, chunk->z * CHUNK_D - 1);
-	chunks->getVoxels(voxelsBuffer, settings.graphics.backlight);
+void BlocksRenderer::prepare(const Chunk* chunk, const ChunksStorage* chunks) {
+	chunkX = chunk->x;
+	chunkZ = chunk->z;
+	chunkBottom = chunk->bottom;
+	chunkTop = chunk->top;
+	neighbourhood->prepare(chunk, chunks);
+	// backlight makes light passing blocks at least 1 level bright
+	lightBias = settings.graphics.backlight ? 0x00010101u : 0;
+	greedy = settings.graphics.greedyMeshing;
+}
+
+size_t BlocksRenderer::countFaces(const voxel* voxels) const {
+	// occluders rows around the section, bit x + 1 is set if voxel x
+	// (-1..CHUNK_W) hides neighbour cube face, so faces of a row are
+	// tested at once
+	uint32_t occluders[CHUNK_SECTION_H + 2][CHUNK_D + 2];
+	uint32_t cubes[CHUNK_SECTION_H][CHUNK_D];
+	auto occludes = [this](int x, int y, int z) {
+		blockid_t id = neighbourhood->pickBlockId(x, y, z);
+		return id == BLOCK_VOID || (blockInfo[id].flags & BlockMeshFlag::OCCLUDER);
+	};
+	size_t faces = 0;
+	for (int y = bottom - 1; y <= top; y++) {
+		const bool section = y >= bottom && y < top;
+		for (int z = -1; z <= CHUNK_D; z++) {
+			const bool column = z >= 0 && z < CHUNK_D;
+			// corner rows are not neighbours of the section rows
+			if (!section && !column)
+				continue;
+			const bool inside = column && y >= 0 && y < CHUNK_H;
+			uint32_t row = 0;
+			uint32_t cubesRow = 0;
+			if (inside) {
+				const voxel* rowVoxels = voxels + vox_index(0, y, z);
+				for (int x = 0; x < CHUNK_W; x++) {
+					blockid_t id = rowVoxels[x].id;
+					const BlockMeshInfo& info = blockInfo[id];
+					if (info.flags & BlockMeshFlag::OCCLUDER)
+						row |= 1u << (x + 1);
+					if (!section || id == 0)
+						continue;
+					if (info.flags & BlockMeshFlag::CUBE) {
+						cubesRow |= 1u << (x + 1);
+					} else {
+						faces += info.maxFaces;
+					}
+				}
+				row |= uint32_t(occludes(-1, y, z));
+				row |= uint32_t(occludes(CHUNK_W, y, z)) << (CHUNK_W + 1);
+			} else {
+				for (int x = -1; x <= CHUNK_W; x++) {
+					row |= uint32_t(occludes(x, y, z)) << (x + 1);
+				}
+			}
+			occluders[y - bottom + 1][z + 1] = row;
+			if (section && inside) {
+				cubes[y - bottom][z] = cubesRow;
+			}
+		}
+	}
+	for (int y = 0; y < top - bottom; y++) {
+		for (int z = 0; z < CHUNK_D; z++) {
+			const uint32_t row = cubes[y][z];
+			if (row == 0)
+				continue;
+			const uint32_t around = occluders[y + 1][z + 1];
+			faces += count_bits(row & ~(around >> 1)) + 
+					 count_bits(row & ~(around << 1)) +
+					 count_bits(row & ~occluders[y + 1][z]) + 
+					 count_bits(row & ~occluders[y + 1][z + 2]) +
+					 count_bits(row & ~occluders[y][z + 1]) + 
+					 count_bits(row & ~occluders[y + 2][z + 1]);
+		}
+	}
+	return faces;
+}
+
+size_t BlocksRenderer::countLodFaces(int scale) const {
+	const int width = CHUNK_W / scale;
+	const int depth = CHUNK_D / scale;
+	size_t faces = 0;
+	for (int cy = bottom / scale; cy * scale < top; cy++) {
+		const blockid_t* cells = lodCells.data() + cy * depth * width;
+		for (int i = 0; i < depth * width; i++) {
+			faces += cells[i] ? 6 : 0;
+		}
+	}
+	return faces;
+}
+
+sconnect_t BlocksRenderer::computeConnectivity(const voxel* voxels, int section) const {
+	uint16_t opaque[CHUNK_SECTION_H * CHUNK_D];
+	for (int y = 0; y < CHUNK_SECTION_H; y++) {
+		for (int z = 0; z < CHUNK_D; z++) {
+			const voxel* rowVoxels = voxels + vox_index(0, section * CHUNK_SECTION_H + y, z);
+			uint16_t row = 0;
+			for (int x = 0; x < CHUNK_W; x++) {
+				if (blockInfo[rowVoxels[x].id].flags & BlockMeshFlag::OCCLUDER)
+					row |= 1u << x;
+			}
+			opaque[y * CHUNK_D + z] = row;
+		}
+	}
+	return occlusion::compute_connectivity(opaque);
+}
+
+void BlocksRenderer::build(uint32_t sectionsMask, int lod) {
 	overflow = false;
+	truncated = false;
 	vertexOffset = 0;
-	indexOffset = indexSize = 0;
-	const voxel* voxels = chunk->voxels;
-	render(voxels);
+	indexSize = 0;
+
+	const voxel* voxels = neighbourhood->getVoxels();
+	const int scale = 1 << lod;
+	if (lod) {
+		buildLodCells(scale);
+	}
+	estimatedFaces = 0;
+	for (int i = 0; i < CHUNK_SECTIONS; i++) {
+		bottom = std::max(chunkBottom, i * CHUNK_SECTION_H);
+		top = std::min(chunkTop, (i + 1) * CHUNK_SECTION_H);
+		if ((sectionsMask & (1 << i)) && bottom < top) {
+			estimatedFaces += lod ? countLodFaces(scale) : countFaces(voxels);
+		}
+	}
+	reserve(estimatedFaces);
+
+	for (int i = 0; i < CHUNK_SECTIONS; i++) {
+		SectionRange& range = sections[i];
+		range.vertexStart = vertexOffset;
+		range.indexStart = indexSize;
+		bottom = std::max(chunkBottom, i * CHUNK_SECTION_H);
+		top = std::min(chunkTop, (i + 1) * CHUNK_SECTION_H);
+		if ((sectionsMask & (1 << i)) && bottom < top && !truncated) {
+			// section mesh indices start from its first vertex
+			indexOffset = 0;
+			if (lod) {
+				renderLod(scale);
+			} else {
+				render(voxels);
+			}
+		}
+		range.vertexEnd = vertexOffset;
+		range.indexEnd = indexSize;
+		if (sectionsMask & (1 << i)) {
+			// voxels out of bottom..top are air
+			connectivity[i] = bottom < top 
+				? computeConnectivity(voxels, i) 
+				: occlusion::CONNECT_ALL;
+		}
+	}
+}
+
+ChunkMeshData BlocksRenderer::getMeshData(int section) const {
+	const SectionRange& range = sections[section];
+	return ChunkMeshData {
+		vertexBuffer + range.vertexStart,
+		(range.vertexEnd - range.vertexStart) / BlocksRenderer::VERTEX_SIZE,
+		indexBuffer + range.indexStart,
+		range.indexEnd - range.indexStart
+	};
+}
+
+sconnect_t BlocksRenderer::getConnectivity(int section) const {
+	return connectivity[section];
+}
+
+size_t BlocksRenderer::getVertexCount() const {
+	return vertexOffset / BlocksRenderer::VERTEX_SIZE;
+}
+
+size_t BlocksRenderer::getEstimatedVertexCount() const {
+	return estimatedFaces * 4;
+}
 
-	const vattr attrs[]{ {3}, {2}, {1}, {0} };
-	size_t vcount = vertexOffset / BlocksRenderer::VERTEX_SIZE;
-	Mesh* mesh = new Mesh(vertexBuffer, vcount, indexBuffer, indexSize, attrs);
-	return mesh;
+bool BlocksRenderer::isOverflow() const {
+	return overflow;
 }
 
-VoxelsVolume* BlocksRenderer::getVoxelsBuffer() const {
-	return voxelsBuffer;
+bool BlocksRenderer::isTruncated() const {
+	return truncated;
 }
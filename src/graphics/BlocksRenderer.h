@@ -4,53 +4,110 @@
 #include <stdlib.h>
 #include <vector>
 #include <glm/glm.hpp>
-#include "UVRegion.h"
 #include "../typedefs.h"
+#include "../constants.h"
 #include "../voxels/voxel.h"
 #include "../settings.h"
+#include "../frontend/ContentGfxCache.h"
+#include "OcclusionCulling.h"
 
 class Content;
-class Mesh;
 class Block;
 class Chunk;
 class Chunks;
-class VoxelsVolume;
+class ChunkNeighbourhood;
 class ChunksStorage;
-class ContentGfxCache;
+struct GreedyFace;
+struct BlockMeshInfo;
+
+/* Built section mesh data in BlocksRenderer buffers: packed vertices
+   (see ChunkVertex.h) and triangle indices, valid until the next build */
+struct ChunkMeshData {
+	const uint32_t* vertices;
+	size_t vertexCount;
+	const int* indices;
+	size_t indexCount;
+};
 
 class BlocksRenderer {
     static const glm::vec3 SUN_VECTOR;
 	static const uint VERTEX_SIZE;
 	const Content* const content;
-	float* vertexBuffer;
+	uint32_t* vertexBuffer;
 	int* indexBuffer;
 	size_t vertexOffset;
 	size_t indexOffset, indexSize;
+	/* Buffers capacity in faces (4 vertices and 6 indices each) */
 	size_t capacity;
+	/* Faces upper bound of the last build (see countFaces) */
+	size_t estimatedFaces = 0;
 
+	/* Estimate has been exceeded, buffers were grown while building */
 	bool overflow = false;
+	/* Buffers could not grow, some faces were dropped */
+	bool truncated = false;
+
+	/* Prepared chunk info (see prepare) */
+	int chunkX = 0;
+	int chunkZ = 0;
+	int chunkBottom = 0;
+	int chunkTop = 0;
+	ChunkNeighbourhood* neighbourhood;
+	/* Added to rgb channels of light passing blocks (backlight) */
+	uint32_t lightBias = 0;
+
+	/* Height range being rendered (part of a section) */
+	int bottom = 0;
+	int top = 0;
+
+	/* Built section data range in vertex and index buffers */
+	struct SectionRange {
+		size_t vertexStart, vertexEnd;
+		size_t indexStart, indexEnd;
+	};
+	SectionRange sections[CHUNK_SECTIONS] {};
+	/* Faces connectivity of built sections (see OcclusionCuller) */
+	sconnect_t connectivity[CHUNK_SECTIONS] {};
 
-	const Chunk* chunk = nullptr;
-	VoxelsVolume* voxelsBuffer;
+	/* Greedy meshing faces mask of a chunk slice */
+	GreedyFace* greedyMask;
+	bool greedy = false;
 
 	const Block* const* blockDefsCache;
+	/* Mesher block properties indexed by block id */
+	BlockMeshInfo* blockInfo;
+	/* Draw groups in rendering order */
+	std::vector<ubyte> drawGroups;
+	/* Downsampled chunk (see buildLodCells), 0 is an empty cell */
+	std::vector<blockid_t> lodCells;
+
+	/* Non-air voxels of the section being rendered in one draw group */
+	struct DrawGroupBucket {
+		std::vector<uint16_t> voxels;
+		/* Has blocks rendered by greedyCubes */
+		bool greedy;
+	};
+	std::vector<DrawGroupBucket> buckets;
 	const ContentGfxCache* const cache;
 	const EngineSettings& settings;
 
-	void vertex(const glm::vec3& coord, float u, float v, const glm::vec4& light);
-	void index(int a, int b, int c, int d, int e, int f);
+	/* Grow buffers to fit the faces count (kept for next builds)
+	   @return false if memory could not be allocated */
+	bool reserve(size_t faces);
+	/* Make sure one more face fits the buffers
+	   @return false if the face must be dropped */
+	inline bool reserveFace();
 
-	void vertex(const glm::vec3& coord, float u, float v, 
-				const glm::vec4& brightness,
-				const glm::vec3& axisX,
-				const glm::vec3& axisY,
-				const glm::vec3& axisZ);
+	/* u, v are texture coordinates in region tiles (repeated if > 1) */
+	void vertex(const glm::vec3& coord, uint u, uint v, uint32_t light, regionid_t region);
+	void vertex(const glm::vec3& coord, uint u, uint v, const glm::vec4& light, regionid_t region);
+	void index(int a, int b, int c, int d, int e, int f);
 
 	void face(const glm::vec3& coord, float w, float h, float d,
 		const glm::vec3& axisX,
 		const glm::vec3& axisY,
         const glm::vec3& axisZ,
-		const UVRegion& region,
+		regionid_t region,
 		const glm::vec4(&lights)[4],
 		const glm::vec4& tint);
 	
@@ -58,7 +115,7 @@ class BlocksRenderer {
 		const glm::vec3& axisX,
 		const glm::vec3& axisY,
 		const glm::vec3& axisZ,
-		const UVRegion& region,
+		regionid_t region,
         bool lights);
 
 	void tetragonicFace(const glm::vec3& coord,
@@ -67,34 +124,103 @@ class BlocksRenderer {
 		const glm::vec3& X,
 		const glm::vec3& Y,
 		const glm::vec3& Z,
-		const UVRegion& texreg,
+		regionid_t texreg,
 		bool lights);
 	
-	void blockCube(int x, int y, int z, const UVRegion(&faces)[6], const Block* block, ubyte states, bool lights);
+	void blockCube(int x, int y, int z, const regionid_t(&faces)[6], const Block* block, ubyte states, bool lights);
+	/* Merge coplanar faces of full cube blocks with the same id
+	   and uniform lighting into larger quads with tiled texture */
+	void greedyCubes(ubyte drawGroup, const voxel* voxels);
 	void blockAABB(const glm::ivec3& coord,
-                    const UVRegion(&faces)[6], 
+                    const regionid_t(&faces)[6], 
                     const Block* block, 
                     ubyte rotation,
                     bool lights);
-	void blockXSprite(int x, int y, int z, const glm::vec3& size, const UVRegion& face1, const UVRegion& face2, float spread);
+	void blockXSprite(int x, int y, int z, const glm::vec3& size, regionid_t face1, regionid_t face2, float spread);
 	void blockCustomModel(const glm::ivec3& icoord,
 		const Block* block, ubyte rotation,
 		bool lights);
 
 	bool isOpenForLight(int x, int y, int z) const;
 	bool isOpen(int x, int y, int z, ubyte group) const;
+	bool isOpen(blockid_t id, ubyte group) const;
+
+	/* Light of the voxel with 4-bit channels unpacked to bytes
+	   (r | g << 8 | b << 16 | s << 24), so samples may be summed.
+	   Zero if the block is not light passing */
+	inline uint32_t sampleLight(uint index) const;
+	uint32_t sampleLight(const glm::ivec3& coord) const;
+	/* Sum of 4 samples around the corner: coord, coord-right, 
+	   coord-right-up, coord-up */
+	uint32_t sampleSoftLight(const glm::ivec3& coord, const glm::ivec3& right, const glm::ivec3& up) const;
 
 	glm::vec4 pickLight(int x, int y, int z) const;
 	glm::vec4 pickLight(const glm::ivec3& coord) const;
 	glm::vec4 pickSoftLight(const glm::ivec3& coord, const glm::ivec3& right, const glm::ivec3& up) const;
-	glm::vec4 pickSoftLight(float x, float y, float z, const glm::ivec3& right, const glm::ivec3& up) const;
+	/* Faces count upper bound of the section (bottom..top): neighbours
+	   are tested for full cubes, model faces are counted for others */
+	size_t countFaces(const voxel* voxels) const;
+	/* Block represents the cell of scale^3 voxels at origin in LOD mesh:
+	   top LOD_FILL block or 0 if there is none */
+	blockid_t pickLodBlock(const voxel* voxels, const glm::ivec3& origin, int scale) const;
+	/* Downsample chunk voxels to cells of scale^3 voxels */
+	void buildLodCells(int scale);
+	/* Average light of scale^2 voxels layer in front of a LOD cell face
+	   @return false if the layer is closed (all voxels are occluders) */
+	bool sampleLodLayer(const glm::ivec3& origin, 
+						const glm::ivec3& right, 
+						const glm::ivec3& up, 
+						int scale, float tint, uint32_t& light) const;
+	/* Faces count upper bound of the section (bottom..top) LOD mesh */
+	size_t countLodFaces(int scale) const;
+	/* Faces connectivity of the section through non-occluder voxels */
+	sconnect_t computeConnectivity(const voxel* voxels, int section) const;
+	/* Render section (bottom..top) of downsampled chunk as cubes
+	   of scale size. Cells faces on the chunk border are hidden only
+	   if neighbour voxels close them, so there are no cracks between 
+	   chunks of different levels of detail */
+	void renderLod(int scale);
+	/* Render section (bottom..top) in a single pass over voxels,
+	   blocks are bucketed by draw group to keep groups order */
 	void render(const voxel* voxels);
 public:
+	/* @param capacity initial buffers capacity in faces, 
+	   buffers grow if a chunk needs more */
 	BlocksRenderer(size_t capacity, const Content* content, const ContentGfxCache* cache, const EngineSettings& settings);
 	virtual ~BlocksRenderer();
 
-	Mesh* render(const Chunk* chunk, const ChunksStorage* chunks);
-	VoxelsVolume* getVoxelsBuffer() const;
+	/* Take snapshot of the chunk and its neighbours borders.
+	   Main thread only */
+	void prepare(const Chunk* chunk, const ChunksStorage* chunks);
+
+	/* Max level of detail (cells of 2^lod voxels) */
+	static const int MAX_LOD = 2;
+
+	/* Build mesh data of the prepared chunk sections. Uses own buffers only,
+	   so may be called from a worker thread
+	   @param sections bit mask of sections to build
+	   @param lod level of detail, 0 - full, 1..MAX_LOD - chunk is 
+	   downsampled to cells of 2^lod voxels */
+	void build(uint32_t sections, int lod=0);
+
+	/* Built section mesh data, no GL context required */
+	ChunkMeshData getMeshData(int section) const;
+
+	/* Faces connectivity of the built section (see OcclusionCuller) */
+	sconnect_t getConnectivity(int section) const;
+
+	/* Vertices count of the last build (all sections) */
+	size_t getVertexCount() const;
+
+	/* Vertices count upper bound of the last build used to size buffers */
+	size_t getEstimatedVertexCount() const;
+
+	/* @return true if the last build exceeded the estimate 
+	   and buffers were grown while building */
+	bool isOverflow() const;
+
+	/* @return true if the last build has dropped faces (out of memory) */
+	bool isTruncated() const;
 };
 
 #endif // GRAPHICS_BLOCKS_RENDERER_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef GRAPHICS_CHUNK_VERTEX_H_
+#define GRAPHICS_CHUNK_VERTEX_H_
+
+#include <math.h>
+#include <glm/glm.hpp>
+#include "../typedefs.h"
+
+/* Packed chunk mesh vertex, 3 x uint32 (decoded in main.glslv):
+   [0] x:11 z:11 u:5 v:5
+   [1] y:16 region:16
+   [2] light r:8 g:8 b:8 s:8
+   Position is chunk-local, stored in 1/64 block units with 1 block offset,
+   u, v are texture coordinates in region tiles,
+   region is index in ContentGfxCache regions table */
+namespace chunk_vertex {
+	/* Vertex size in 4-byte components */
+	const uint SIZE = 3;
+	const float POSITION_SCALE = 64.0f;
+	const float POSITION_OFFSET = 1.0f;
+	/* Max texture coordinate (region tiles) */
+	const uint MAX_TILES = 31;
+
+	struct unpacked {
+		glm::vec3 position;
+		uint u, v;
+		uint16_t region;
+		uint32_t light;
+	};
+
+	inline uint32_t pack_coord(float value, uint32_t max) {
+		float scaled = roundf((value + POSITION_OFFSET) * POSITION_SCALE);
+		if (scaled < 0.0f)
+			return 0;
+		if (scaled > max)
+			return max;
+		return uint32_t(scaled);
+	}
+
+	inline float unpack_coord(uint32_t value) {
+		return value / POSITION_SCALE - POSITION_OFFSET;
+	}
+
+	inline void pack(uint32_t* dst, const glm::vec3& position,
+					 uint u, uint v, uint16_t region, uint32_t light) {
+		dst[0] = pack_coord(position.x, 0x7FF) |
+				 pack_coord(position.z, 0x7FF) << 11 |
+				 (glm::min(u, MAX_TILES) << 22) |
+				 (glm::min(v, MAX_TILES) << 27);
+		dst[1] = pack_coord(position.y, 0xFFFF) | uint32_t(region) << 16;
+		dst[2] = light;
+	}
+
+	inline unpacked unpack(const uint32_t* src) {
+		unpacked vertex;
+		vertex.position.x = unpack_coord(src[0] & 0x7FF);
+		vertex.position.y = unpack_coord(src[1] & 0xFFFF);
+		vertex.position.z = unpack_coord((src[0] >> 11) & 0x7FF);
+		vertex.u = (src[0] >> 22) & 0x1F;
+		vertex.v = src[0] >> 27;
+		vertex.region = src[1] >> 16;
+		vertex.light = src[2];
+		return vertex;
+	}
+}
+
+#endif // GRAPHICS_CHUNK_VERTEX_H_
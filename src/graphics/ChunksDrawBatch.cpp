@@ -0,0 +1,35 @@
+#include "ChunksDrawBatch.h"
+
+void ChunksDrawBatch::clear() {
+	commands.clear();
+	offsets.clear();
+}
+
+void ChunksDrawBatch::add(const ArenaRange& range, const glm::vec3& offset) {
+	if (range.indexCount == 0)
+		return;
+	commands.push_back(DrawElementsCommand {
+		uint32_t(range.indexCount),
+		1,
+		uint32_t(range.indexOffset),
+		int32_t(range.vertexOffset),
+		uint32_t(offsets.size())
+	});
+	offsets.push_back(offset);
+}
+
+const std::vector<DrawElementsCommand>& ChunksDrawBatch::getCommands() const {
+	return commands;
+}
+
+const std::vector<glm::vec3>& ChunksDrawBatch::getOffsets() const {
+	return offsets;
+}
+
+size_t ChunksDrawBatch::size() const {
+	return commands.size();
+}
+
+bool ChunksDrawBatch::empty() const {
+	return commands.empty();
+}
@@ -0,0 +1,51 @@
+#ifndef GRAPHICS_CHUNKS_DRAW_BATCH_H_
+#define GRAPHICS_CHUNKS_DRAW_BATCH_H_
+
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+#include <glm/glm.hpp>
+
+/* Geometry placed in GeometryArena buffers, offsets and counts
+   are in vertices and indices. Indices are relative to the first vertex */
+struct ArenaRange {
+	size_t vertexOffset;
+	size_t vertexCount;
+	size_t indexOffset;
+	size_t indexCount;
+};
+
+/* Indirect draw command, same layout as used by 
+   glMultiDrawElementsIndirect */
+struct DrawElementsCommand {
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t baseVertex;
+	/* Index of the command offset (per-instance attribute) */
+	uint32_t baseInstance;
+};
+static_assert(sizeof(DrawElementsCommand) == 20, "indirect command layout");
+
+/* Chunk sections draws of a frame in drawing order, built on CPU
+   and submitted by GeometryArena::draw */
+class ChunksDrawBatch {
+	std::vector<DrawElementsCommand> commands;
+	/* World position of the section mesh origin per command */
+	std::vector<glm::vec3> offsets;
+public:
+	void clear();
+
+	/* Add section geometry draw
+	   @param range geometry placed in arena
+	   @param offset mesh origin position in world */
+	void add(const ArenaRange& range, const glm::vec3& offset);
+
+	const std::vector<DrawElementsCommand>& getCommands() const;
+	const std::vector<glm::vec3>& getOffsets() const;
+
+	size_t size() const;
+	bool empty() const;
+};
+
+#endif // GRAPHICS_CHUNKS_DRAW_BATCH_H_
@@ -0,0 +1,42 @@
+#include "ChunksDrawList.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../constants.h"
+#include "../maths/voxmaths.h"
+
+bool ChunksDrawList::update(int w, int d, int ox, int oz, const glm::vec3& cameraPosition) {
+	glm::ivec2 camera (
+		floordiv(int(std::floor(cameraPosition.x)), CHUNK_W),
+		floordiv(int(std::floor(cameraPosition.z)), CHUNK_D)
+	);
+	if (!slots.empty() && w == this->w && d == this->d && ox == this->ox && 
+		oz == this->oz && camera == this->camera) {
+		return false;
+	}
+	this->w = w;
+	this->d = d;
+	this->ox = ox;
+	this->oz = oz;
+	this->camera = camera;
+
+	const size_t volume = size_t(w) * d;
+	slots.resize(volume);
+	distances.resize(volume);
+	for (size_t i = 0; i < volume; i++) {
+		int dx = ox + int(i % w) - camera.x;
+		int dz = oz + int(i / w) - camera.y;
+		slots[i] = i;
+		distances[i] = dx * dx + dz * dz;
+	}
+	const int* keys = distances.data();
+	std::sort(slots.begin(), slots.end(), [keys](size_t a, size_t b) {
+		return keys[a] > keys[b] || (keys[a] == keys[b] && a < b);
+	});
+	return true;
+}
+
+const std::vector<size_t>& ChunksDrawList::getSlots() const {
+	return slots;
+}
@@ -0,0 +1,30 @@
+#ifndef GRAPHICS_CHUNKS_DRAW_LIST_H_
+#define GRAPHICS_CHUNKS_DRAW_LIST_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/* Chunks area slots (see Chunks::chunks) in drawing order: far to near
+   from the camera chunk. Order depends on the area and camera chunk
+   only, so the list is kept between frames and sorted again when one
+   of them changes. Empty slots are kept in the list */
+class ChunksDrawList {
+	std::vector<size_t> slots;
+	/* Squared distance of slots to the camera chunk (chunks) */
+	std::vector<int> distances;
+	int w = 0;
+	int d = 0;
+	int ox = 0;
+	int oz = 0;
+	glm::ivec2 camera {};
+public:
+	/* Sort list if the area or camera chunk has changed
+	   @param w, d, ox, oz chunks area size and position (chunks)
+	   @param cameraPosition camera position in world
+	   @return true if the list has been sorted */
+	bool update(int w, int d, int ox, int oz, const glm::vec3& cameraPosition);
+
+	const std::vector<size_t>& getSlots() const;
+};
+
+#endif // GRAPHICS_CHUNKS_DRAW_LIST_H_
@@ -1,51 +1,352 @@
 #include "ChunksRenderer.h"
 
-#include "Mesh.h"
 #include "BlocksRenderer.h"
 #include "../voxels/Chunk.h"
 #include "../world/Level.h"
+#include "../devtools/profiler.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
 using glm::ivec2;
 
-ChunksRenderer::ChunksRenderer(Level* level, const ContentGfxCache* cache, const EngineSettings& settings) : level(level) {
-	const int MAX_FULL_CUBES = 3000;
-	renderer = new BlocksRenderer(9 * 6 * 6 * MAX_FULL_CUBES, level->content, cache, settings);
+/* Initial mesh buffers capacity, grown up to the largest chunk built */
+const int INITIAL_MESH_FACES = 4096;
+/* Initial chunks geometry arena capacity, grown when full */
+const size_t INITIAL_ARENA_VERTICES = 1 << 20;
+const size_t INITIAL_ARENA_INDICES = INITIAL_ARENA_VERTICES / 4 * 6;
+const int MAX_RENDERER_WORKERS = 4;
+/* Distance (chunks) beyond levels border to change level of detail */
+const float LOD_HYSTERESIS = 1.0f;
+/* Meshes are dropped to this part of the memory budget, 
+   so eviction does not run on every new mesh */
+const double EVICTION_TARGET = 0.9;
+
+/* Chunk meshing thread. Voxels are copied to the worker BlocksRenderer
+   on the main thread (see start), so the worker never touches level data */
+class RendererWorker {
+	std::unique_ptr<BlocksRenderer> renderer;
+	std::mutex mutex;
+	std::condition_variable variable;
+	bool working = true;
+	bool assigned = false;
+	std::atomic<bool> done {false};
+	std::thread thread;
+
+	ivec2 chunk {};
+	uint32_t sections = 0;
+	int lod = 0;
+	bool busy = false;
+	bool discarded = false;
+
+	void run() {
+		profiler::set_thread_name("chunks mesher");
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			variable.wait(lock, [this]() {
+				return assigned || !working;
+			});
+			if (!working) {
+				break;
+			}
+			lock.unlock();
+			{
+				profiler::Scope scope("BlocksRenderer::build");
+				renderer->build(sections, lod);
+			}
+			lock.lock();
+			assigned = false;
+			done = true;
+		}
+	}
+public:
+	RendererWorker(const Content* content,
+				   const ContentGfxCache* cache,
+				   const EngineSettings& settings)
+		: renderer(std::make_unique<BlocksRenderer>(
+			INITIAL_MESH_FACES, content, cache, settings)),
+		  thread(&RendererWorker::run, this) {
+	}
+
+	~RendererWorker() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			working = false;
+		}
+		variable.notify_one();
+		thread.join();
+	}
+
+	/* Take chunk voxels snapshot and start building. Main thread only
+	   @param sections bit mask of chunk sections to build
+	   @param lod level of detail */
+	void start(const Chunk* chunk, const ChunksStorage* chunks, uint32_t sections, int lod) {
+		renderer->prepare(chunk, chunks);
+		this->chunk = ivec2(chunk->x, chunk->z);
+		this->sections = sections;
+		this->lod = lod;
+		busy = true;
+		discarded = false;
+		done = false;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			assigned = true;
+		}
+		variable.notify_one();
+	}
+
+	/* Replace built sections of the chunk mesh (GL upload),
+	   worker becomes free */
+	void upload(ChunkMesh& mesh, GeometryArena& geometry) {
+		busy = false;
+		if (renderer->isOverflow())
+			ChunksRenderer::meshOverflows++;
+		if (renderer->isTruncated())
+			ChunksRenderer::meshTruncations++;
+		mesh.lod = lod;
+		mesh.bytes = 0;
+		for (int i = 0; i < CHUNK_SECTIONS; i++) {
+			if (sections & (1 << i)) {
+				// previous section geometry is freed first
+				mesh.sections[i] = nullptr;
+				mesh.sections[i] = geometry.upload(renderer->getMeshData(i));
+				mesh.connectivity[i] = renderer->getConnectivity(i);
+				ChunksRenderer::rebuiltSections++;
+			}
+			if (mesh.sections[i]) {
+				mesh.bytes += mesh.sections[i]->getBytes();
+			}
+		}
+		ChunksRenderer::rebuiltChunks++;
+	}
+
+	/* Drop the finished build, worker becomes free */
+	void release() {
+		busy = false;
+	}
+
+	/* Chunk has been unloaded, build result must be dropped */
+	void discard() {
+		discarded = true;
+	}
+
+	bool isBusy() const {
+		return busy;
+	}
+
+	bool isDone() const {
+		return busy && done;
+	}
+
+	bool isDiscarded() const {
+		return discarded;
+	}
+
+	ivec2 getChunk() const {
+		return chunk;
+	}
+};
+
+size_t ChunksRenderer::rebuiltChunks = 0;
+size_t ChunksRenderer::rebuiltSections = 0;
+size_t ChunksRenderer::meshOverflows = 0;
+size_t ChunksRenderer::meshTruncations = 0;
+size_t ChunksRenderer::geometryUsed = 0;
+size_t ChunksRenderer::geometryCapacity = 0;
+size_t ChunksRenderer::meshesCount = 0;
+size_t ChunksRenderer::meshesMemory = 0;
+size_t ChunksRenderer::evictedMeshes = 0;
+
+ChunksRenderer::ChunksRenderer(Level* level, const ContentGfxCache* cache, const EngineSettings& settings) 
+	: level(level), 
+	  settings(settings),
+	  geometry(std::make_unique<GeometryArena>(
+		  INITIAL_ARENA_VERTICES, INITIAL_ARENA_INDICES, 
+		  settings.graphics.multiDrawIndirect)) {
+	int count = int(std::thread::hardware_concurrency())-1;
+	count = std::max(1, std::min(MAX_RENDERER_WORKERS, count));
+	for (int i = 0; i < count; i++) {
+		workers.push_back(std::make_unique<RendererWorker>(level->content, cache, settings));
+	}
 }
 
 ChunksRenderer::~ChunksRenderer() {
-	delete renderer;
 }
 
-std::shared_ptr<Mesh> ChunksRenderer::render(Chunk* chunk) {
-	chunk->setModified(false);
-	Mesh* mesh = renderer->render(chunk, level->chunksStorage);
-	auto sptr = std::shared_ptr<Mesh>(mesh);
-	meshes[ivec2(chunk->x, chunk->z)] = sptr;
-	return sptr;
+void ChunksRenderer::unload(Chunk* chunk) {
+	ivec2 key (chunk->x, chunk->z);
+	drop(key);
+	evicted.erase(key);
 }
 
-void ChunksRenderer::unload(Chunk* chunk) {
-	auto found = meshes.find(ivec2(chunk->x, chunk->z));
+void ChunksRenderer::drop(const ivec2& key) {
+	auto found = meshes.find(key);
 	if (found != meshes.end()) {
+		meshesBytes -= found->second->bytes;
 		meshes.erase(found);
 	}
+	queue.erase(key);
+	for (auto& worker : workers) {
+		if (worker->isBusy() && worker->getChunk() == key) {
+			worker->discard();
+		}
+	}
 }
 
-std::shared_ptr<Mesh> ChunksRenderer::getOrRender(Chunk* chunk) {
-	auto found = meshes.find(ivec2(chunk->x, chunk->z));
-	if (found != meshes.end() && !chunk->isModified()){
-		return found->second;
+void ChunksRenderer::evict(size_t budget) {
+	if (meshesBytes <= budget)
+		return;
+	const size_t target = budget * EVICTION_TARGET;
+	float px = cameraPosition.x / (float)CHUNK_W - 0.5f;
+	float pz = cameraPosition.z / (float)CHUNK_D - 0.5f;
+	struct candidate {
+		ivec2 key;
+		uint64_t lastVisible;
+		float distance;
+	};
+	std::vector<candidate> candidates;
+	for (auto& entry : meshes) {
+		const ivec2& key = entry.first;
+		// meshes in view are kept even if the budget is exceeded
+		if (entry.second->lastVisible == frame)
+			continue;
+		float distance = (key.x - px) * (key.x - px) + (key.y - pz) * (key.y - pz);
+		candidates.push_back({key, entry.second->lastVisible, distance});
 	}
-	return render(chunk);
+	std::sort(candidates.begin(), candidates.end(), [](const candidate& a, const candidate& b) {
+		if (a.lastVisible != b.lastVisible)
+			return a.lastVisible < b.lastVisible;
+		return a.distance > b.distance;
+	});
+	for (const auto& entry : candidates) {
+		if (meshesBytes <= target)
+			break;
+		drop(entry.key);
+		evicted.insert(entry.key);
+		evictedMeshes++;
+	}
+}
+
+int ChunksRenderer::selectLod(const Chunk* chunk, int current) const {
+	const float levelDistance = settings.graphics.lodDistance;
+	if (levelDistance <= 0.0f)
+		return 0;
+	float dx = chunk->x + 0.5f - cameraPosition.x / CHUNK_W;
+	float dz = chunk->z + 0.5f - cameraPosition.z / CHUNK_D;
+	float distance = std::sqrt(dx * dx + dz * dz);
+	int lod = std::min(int(distance / levelDistance), BlocksRenderer::MAX_LOD);
+	float border = levelDistance * std::max(lod, current);
+	if (lod != current && std::abs(distance - border) < LOD_HYSTERESIS)
+		return current;
+	return lod;
 }
 
-std::shared_ptr<Mesh> ChunksRenderer::get(Chunk* chunk) {
+std::shared_ptr<ChunkMesh> ChunksRenderer::getOrRender(Chunk* chunk, bool visible) {
+	ivec2 key (chunk->x, chunk->z);
+	auto found = meshes.find(key);
+	if (found == meshes.end()) {
+		if (visible || evicted.find(key) == evicted.end()) {
+			queue.insert(key);
+		}
+		return nullptr;
+	}
+	auto& mesh = found->second;
+	if (visible) {
+		mesh->lastVisible = frame;
+	}
+	if (chunk->isModified() || selectLod(chunk, mesh->lod) != mesh->lod) {
+		queue.insert(key);
+	}
+	return mesh;
+}
+
+std::shared_ptr<ChunkMesh> ChunksRenderer::get(Chunk* chunk) {
 	auto found = meshes.find(ivec2(chunk->x, chunk->z));
 	if (found != meshes.end()) {
 		return found->second;
 	}
 	return nullptr;
 }
+
+GeometryArena* ChunksRenderer::getGeometry() const {
+	return geometry.get();
+}
+
+void ChunksRenderer::update(const glm::vec3& cameraPosition) {
+	profiler::Scope scope("ChunksRenderer::update");
+	this->cameraPosition = cameraPosition;
+	for (auto& worker : workers) {
+		if (!worker->isDone())
+			continue;
+		if (worker->isDiscarded()) {
+			worker->release();
+		} else {
+			auto& mesh = meshes[worker->getChunk()];
+			if (mesh == nullptr) {
+				mesh = std::make_shared<ChunkMesh>();
+				mesh->lastVisible = frame;
+				evicted.erase(worker->getChunk());
+			}
+			meshesBytes -= mesh->bytes;
+			worker->upload(*mesh, *geometry);
+			meshesBytes += mesh->bytes;
+		}
+	}
+	const size_t mb = 1024 * 1024;
+	if (settings.graphics.meshMemoryBudget) {
+		evict(settings.graphics.meshMemoryBudget * mb);
+	}
+	frame++;
+	meshesCount = meshes.size();
+	meshesMemory = meshesBytes;
+	geometryUsed = geometry->getUsedBytes();
+	geometryCapacity = geometry->getCapacityBytes();
+	if (queue.empty())
+		return;
+
+	float px = cameraPosition.x / (float)CHUNK_W - 0.5f;
+	float pz = cameraPosition.z / (float)CHUNK_D - 0.5f;
+	std::vector<ivec2> sorted (queue.begin(), queue.end());
+	std::sort(sorted.begin(), sorted.end(), [px, pz](const ivec2& a, const ivec2& b) {
+		return (a.x - px) * (a.x - px) + (a.y - pz) * (a.y - pz) <
+			   (b.x - px) * (b.x - px) + (b.y - pz) * (b.y - pz);
+	});
+
+	auto isBuilding = [this](const ivec2& key) {
+		for (auto& worker : workers) {
+			if (worker->isBusy() && worker->getChunk() == key)
+				return true;
+		}
+		return false;
+	};
+
+	size_t next = 0;
+	for (auto& worker : workers) {
+		if (worker->isBusy())
+			continue;
+		while (next < sorted.size()) {
+			ivec2 key = sorted[next++];
+			// rebuild will start after the current one is finished
+			if (isBuilding(key))
+				continue;
+			queue.erase(key);
+			auto chunk = level->chunksStorage->get(key.x, key.y);
+			if (chunk == nullptr || !chunk->isLighted())
+				continue;
+			uint32_t sections = chunk->takeModifiedSections();
+			auto found = meshes.find(key);
+			int lod = selectLod(chunk.get(), found == meshes.end() ? 0 : found->second->lod);
+			if (sections == 0 || found == meshes.end() || found->second->lod != lod) {
+				sections = ALL_CHUNK_SECTIONS;
+			}
+			worker->start(chunk.get(), level->chunksStorage, sections, lod);
+			break;
+		}
+	}
+}
@@ -1,35 +1,112 @@
 #ifndef SRC_GRAPHICS_CHUNKSRENDERER_H_
 #define SRC_GRAPHICS_CHUNKSRENDERER_H_
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <glm/glm.hpp>
 #include "../voxels/Block.h"
 #include "../voxels/ChunksStorage.h"
 #include "../settings.h"
+#include "../constants.h"
+#include "OcclusionCulling.h"
+#include "GeometryArena.h"
 
-class Mesh;
 class Chunk;
 class Level;
 class BlocksRenderer;
 class ContentGfxCache;
+class RendererWorker;
+
+/* Chunk mesh split to CHUNK_SECTION_H high sections,
+   so block edit rebuilds only affected sections.
+   Sections geometry is placed in the shared GeometryArena,
+   empty section mesh is nullptr */
+struct ChunkMesh {
+	std::unique_ptr<ArenaMesh> sections[CHUNK_SECTIONS];
+	/* Sections faces connectivity (see OcclusionCuller) */
+	sconnect_t connectivity[CHUNK_SECTIONS];
+	/* Level of detail the mesh is built with (see BlocksRenderer::build) */
+	int lod = 0;
+	/* Sections geometry memory */
+	size_t bytes = 0;
+	/* ChunksRenderer frame the chunk was in view last time */
+	uint64_t lastVisible = 0;
+
+	ChunkMesh() {
+		std::fill_n(connectivity, CHUNK_SECTIONS, occlusion::CONNECT_ALL);
+	}
+};
 
 class ChunksRenderer {
-	BlocksRenderer* renderer;
 	Level* level;
-	std::unordered_map<glm::ivec2, std::shared_ptr<Mesh>> meshes;
+	const EngineSettings& settings;
+	/* Camera position of the last update */
+	glm::vec3 cameraPosition {};
+	/* Geometry of all meshes, declared first to outlive them */
+	std::unique_ptr<GeometryArena> geometry;
+	std::unordered_map<glm::ivec2, std::shared_ptr<ChunkMesh>> meshes;
+	/* Workers with own BlocksRenderer and voxels snapshot each */
+	std::vector<std::unique_ptr<RendererWorker>> workers;
+	/* Chunks waiting for a free worker */
+	std::unordered_set<glm::ivec2> queue;
+	/* Chunks with mesh dropped by memory budget, built again only
+	   when in view */
+	std::unordered_set<glm::ivec2> evicted;
+	/* Geometry memory of all meshes */
+	size_t meshesBytes = 0;
+	/* Updates counter */
+	uint64_t frame = 1;
+
+	/* Level of detail for the chunk by distance to the camera. 
+	   Current level is kept near the levels border to avoid rebuilds
+	   when camera moves back and forth */
+	int selectLod(const Chunk* chunk, int current) const;
+
+	/* Drop the chunk mesh and its builds in progress */
+	void drop(const glm::ivec2& key);
+
+	/* Drop meshes not in view on this frame, least recently visible
+	   and then farthest first, while meshes memory exceeds the budget */
+	void evict(size_t budget);
 public:
+	/* Uploaded chunk meshes and sections count (debug info) */
+	static size_t rebuiltChunks;
+	static size_t rebuiltSections;
+	/* Builds exceeded the mesh size estimate / dropped faces (debug info) */
+	static size_t meshOverflows;
+	static size_t meshTruncations;
+	/* Used and allocated chunks geometry memory in bytes (debug info) */
+	static size_t geometryUsed;
+	static size_t geometryCapacity;
+	/* Chunk meshes kept, their memory in bytes and meshes dropped 
+	   by memory budget (debug info) */
+	static size_t meshesCount;
+	static size_t meshesMemory;
+	static size_t evictedMeshes;
+
 	ChunksRenderer(Level* level, 
 				   const ContentGfxCache* cache, 
 				   const EngineSettings& settings);
 	virtual ~ChunksRenderer();
 
-	std::shared_ptr<Mesh> render(Chunk* chunk);
 	void unload(Chunk* chunk);
 
-	std::shared_ptr<Mesh> getOrRender(Chunk* chunk);
-	std::shared_ptr<Mesh> get(Chunk* chunk);
+	/* Get chunk mesh. Outdated mesh is returned while the new one 
+	   is being built, nullptr if chunk has no mesh yet.
+	   Missing or outdated mesh is queued for building 
+	   (mesh dropped by memory budget - only if chunk is visible)
+	   @param visible chunk is in view, mesh is kept by memory budget */
+	std::shared_ptr<ChunkMesh> getOrRender(Chunk* chunk, bool visible);
+	std::shared_ptr<ChunkMesh> get(Chunk* chunk);
+
+	GeometryArena* getGeometry() const;
 
+	/* Upload meshes built by workers and give queued chunks 
+	   (closest to the camera first) to free workers */
+	void update(const glm::vec3& cameraPosition);
 };
 
-#endif // SRC_GRAPHICS_CHUNKSRENDERER_H_
\ No newline at end of file
+#endif // SRC_GRAPHICS_CHUNKSRENDERER_H_
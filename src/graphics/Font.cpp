@@ -2,6 +2,8 @@
 #include "Texture.h"
 #include "Batch2D.h"
 
+#include <algorithm>
+
 using glm::vec4;
 
 Font::Font(std::vector<std::unique_ptr<Texture>> pages, int lineHeight, int yoffset) 
@@ -34,53 +36,61 @@ bool Font::isPrintableChar(int c) {
 
 const int RES = 16;
 
-int Font::calcWidth(std::wstring text) {
+int Font::calcWidth(const std::wstring& text) {
 	return text.length() * 8;
 }
 
-void Font::draw(Batch2D* batch, std::wstring text, int x, int y) {
+void Font::layout(const std::wstring& text, textlayout& layout) {
+	layout.glyphs.clear();
+	int x = 0;
+	for (unsigned c : text) {
+		if (isPrintableChar(c)) {
+			layout.glyphs.push_back({c, x});
+		}
+		x += 8;//getGlyphWidth(c);
+	}
+	layout.width = x;
+	// glyphs are drawn page by page to switch textures once per page
+	std::stable_sort(layout.glyphs.begin(), layout.glyphs.end(), 
+		[](const textlayout::glyph& a, const textlayout::glyph& b) {
+			return (a.code >> 8) < (b.code >> 8);
+		}
+	);
+}
+
+void Font::draw(Batch2D* batch, const std::wstring& text, int x, int y) {
 	draw(batch, text, x, y, STYLE_NONE);
 }
 
-void Font::draw(Batch2D* batch, std::wstring text, int x, int y, int style) {
-	int page = 0;
-	int next = 10000;
-	int init_x = x;
-	do {
-		for (unsigned c : text){
-			if (isPrintableChar(c)){
-				int charpage = c >> 8;
-				if (charpage == page){
-				    Texture* texture = pages[charpage].get();
-				    if (texture == nullptr){
-				        texture = pages[0].get();
-				    }
-					batch->texture(texture);
+void Font::draw(Batch2D* batch, const std::wstring& text, int x, int y, int style) {
+	layout(text, tempLayout);
+	draw(batch, tempLayout, x, y, style);
+}
 
-					switch (style){
-						case STYLE_SHADOW:
-							batch->sprite(x+1, y+1, RES, RES, 16, c, vec4(0.0f, 0.0f, 0.0f, 1.0f));
-							break;
-						case STYLE_OUTLINE:
-							for (int oy = -1; oy <= 1; oy++){
-								for (int ox = -1; ox <= 1; ox++){
-									if (ox || oy)
-										batch->sprite(x+ox, y+oy, RES, RES, 16, c, vec4(0.0f, 0.0f, 0.0f, 1.0f));
-								}
-							}
-							break;
-					}
+void Font::draw(Batch2D* batch, const textlayout& layout, int x, int y, int style) {
+	for (auto& glyph : layout.glyphs) {
+		const uint c = glyph.code;
+		Texture* texture = pages[c >> 8].get();
+		if (texture == nullptr){
+			texture = pages[0].get();
+		}
+		batch->texture(texture);
 
-					batch->sprite(x, y, RES, RES, 16, c, batch->color);
-				}
-				else if (charpage > page && charpage < next){
-					next = charpage;
+		const int gx = x + glyph.x;
+		switch (style){
+			case STYLE_SHADOW:
+				batch->sprite(gx+1, y+1, RES, RES, 16, c, vec4(0.0f, 0.0f, 0.0f, 1.0f));
+				break;
+			case STYLE_OUTLINE:
+				for (int oy = -1; oy <= 1; oy++){
+					for (int ox = -1; ox <= 1; ox++){
+						if (ox || oy)
+							batch->sprite(gx+ox, y+oy, RES, RES, 16, c, vec4(0.0f, 0.0f, 0.0f, 1.0f));
+					}
 				}
-			}
-			x += 8;//getGlyphWidth(c);
+				break;
 		}
-		page = next;
-		next = 10000;
-		x = init_x;
-	} while (page < 10000);
+
+		batch->sprite(gx, y, RES, RES, 16, c, batch->color);
+	}
 }
@@ -13,9 +13,22 @@ const uint STYLE_NONE = 0;
 const uint STYLE_SHADOW = 1;
 const uint STYLE_OUTLINE = 2;
 
+/* Text glyphs grouped by font page (drawing order), built once
+   and drawn while the text is not changed */
+struct textlayout {
+	struct glyph {
+		uint code;
+		int x;
+	};
+	std::vector<glyph> glyphs;
+	int width = 0;
+};
+
 class Font {
 	int lineHeight;
     int yoffset;
+	/* Layout of texts drawn without cache */
+	textlayout tempLayout;
 public:
 	std::vector<std::unique_ptr<Texture>> pages;
 	Font(std::vector<std::unique_ptr<Texture>> pages, int lineHeight, int yoffset);
@@ -23,11 +36,14 @@ public:
 
 	int getLineHeight() const;
     int getYOffset() const;
-	int calcWidth(std::wstring text);
+	int calcWidth(const std::wstring& text);
 	// int getGlyphWidth(char c);
 	bool isPrintableChar(int c);
-	void draw(Batch2D* batch, std::wstring text, int x, int y);
-	void draw(Batch2D* batch, std::wstring text, int x, int y, int style);
+	/* Build layout of the text (previous content is replaced) */
+	void layout(const std::wstring& text, textlayout& layout);
+	void draw(Batch2D* batch, const textlayout& layout, int x, int y, int style=STYLE_NONE);
+	void draw(Batch2D* batch, const std::wstring& text, int x, int y);
+	void draw(Batch2D* batch, const std::wstring& text, int x, int y, int style);
 };
 
 #endif /* GRAPHICS_FONT_H_ */
@@ -0,0 +1,190 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+#include <GL/glew.h>
+
+#include "BlocksRenderer.h"
+#include "ChunkVertex.h"
+
+/* Main shader vertex attributes locations */
+const uint ATTR_PACKED = 0;
+const uint ATTR_OFFSET = 1;
+
+const size_t VERTEX_BYTES = chunk_vertex::SIZE * sizeof(uint32_t);
+const size_t INDEX_BYTES = sizeof(int);
+
+/* Replace stream buffer data, buffer storage is reallocated
+   to let the driver keep the previous frame data in use */
+static void stream_data(uint target, const void* data, size_t size, size_t& capacity) {
+	if (size > capacity) {
+		capacity = std::max(size, capacity * 2);
+	}
+	glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(target, 0, size, data);
+}
+
+ArenaMesh::ArenaMesh(GeometryArena* arena, ArenaRange range) 
+	: arena(arena), range(range) {
+}
+
+ArenaMesh::~ArenaMesh() {
+	arena->free(range);
+}
+
+const ArenaRange& ArenaMesh::getRange() const {
+	return range;
+}
+
+size_t ArenaMesh::getBytes() const {
+	return range.vertexCount * VERTEX_BYTES + range.indexCount * INDEX_BYTES;
+}
+
+GeometryArena::GeometryArena(size_t vertexCapacity, size_t indexCapacity, bool indirect)
+	: vertices(vertexCapacity), 
+	  indices(indexCapacity),
+	  indirect(indirect && GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance) {
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ibo);
+	if (this->indirect) {
+		glGenBuffers(1, &offsetsBuffer);
+		glGenBuffers(1, &commandsBuffer);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertexCapacity * VERTEX_BYTES, nullptr, GL_STATIC_DRAW);
+
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * INDEX_BYTES, nullptr, GL_STATIC_DRAW);
+	setupAttributes();
+	glBindVertexArray(0);
+}
+
+GeometryArena::~GeometryArena() {
+	glDeleteVertexArrays(1, &vao);
+	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &ibo);
+	if (indirect) {
+		glDeleteBuffers(1, &offsetsBuffer);
+		glDeleteBuffers(1, &commandsBuffer);
+	}
+}
+
+void GeometryArena::setupAttributes() {
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glVertexAttribIPointer(ATTR_PACKED, chunk_vertex::SIZE, GL_UNSIGNED_INT, 
+						   VERTEX_BYTES, (GLvoid*)0);
+	glEnableVertexAttribArray(ATTR_PACKED);
+	if (indirect) {
+		glBindBuffer(GL_ARRAY_BUFFER, offsetsBuffer);
+		glVertexAttribPointer(ATTR_OFFSET, 3, GL_FLOAT, GL_FALSE, 
+							  sizeof(glm::vec3), (GLvoid*)0);
+		glVertexAttribDivisor(ATTR_OFFSET, 1);
+		glEnableVertexAttribArray(ATTR_OFFSET);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryArena::growBuffer(uint& buffer, size_t size, size_t capacity) {
+	uint grown;
+	glGenBuffers(1, &grown);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+	glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+	buffer = grown;
+}
+
+void GeometryArena::growVertices(size_t capacity) {
+	growBuffer(vbo, vertices.getCapacity() * VERTEX_BYTES, capacity * VERTEX_BYTES);
+	vertices.grow(capacity);
+	glBindVertexArray(vao);
+	setupAttributes();
+	glBindVertexArray(0);
+}
+
+void GeometryArena::growIndices(size_t capacity) {
+	growBuffer(ibo, indices.getCapacity() * INDEX_BYTES, capacity * INDEX_BYTES);
+	indices.grow(capacity);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBindVertexArray(0);
+}
+
+std::unique_ptr<ArenaMesh> GeometryArena::upload(const ChunkMeshData& data) {
+	if (data.indexCount == 0)
+		return nullptr;
+	size_t vertexOffset = vertices.allocate(data.vertexCount);
+	if (vertexOffset == ArenaAllocator::NONE) {
+		size_t capacity = vertices.getCapacity();
+		growVertices(std::max(capacity * 2, capacity + data.vertexCount));
+		vertexOffset = vertices.allocate(data.vertexCount);
+	}
+	size_t indexOffset = indices.allocate(data.indexCount);
+	if (indexOffset == ArenaAllocator::NONE) {
+		size_t capacity = indices.getCapacity();
+		growIndices(std::max(capacity * 2, capacity + data.indexCount));
+		indexOffset = indices.allocate(data.indexCount);
+	}
+	// copy target does not touch vertex array state
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, vertexOffset * VERTEX_BYTES, 
+					data.vertexCount * VERTEX_BYTES, data.vertices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, ibo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset * INDEX_BYTES, 
+					data.indexCount * INDEX_BYTES, data.indices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	return std::make_unique<ArenaMesh>(this, ArenaRange {
+		vertexOffset, data.vertexCount, indexOffset, data.indexCount
+	});
+}
+
+void GeometryArena::free(const ArenaRange& range) {
+	vertices.free(range.vertexOffset, range.vertexCount);
+	indices.free(range.indexOffset, range.indexCount);
+}
+
+size_t GeometryArena::draw(const ChunksDrawBatch& batch) {
+	if (batch.empty())
+		return 0;
+	const auto& commands = batch.getCommands();
+	const auto& offsets = batch.getOffsets();
+	glBindVertexArray(vao);
+	if (indirect) {
+		glBindBuffer(GL_ARRAY_BUFFER, offsetsBuffer);
+		stream_data(GL_ARRAY_BUFFER, offsets.data(), 
+					offsets.size() * sizeof(glm::vec3), offsetsCapacity);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandsBuffer);
+		stream_data(GL_DRAW_INDIRECT_BUFFER, commands.data(), 
+					commands.size() * sizeof(DrawElementsCommand), commandsCapacity);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, commands.size(), 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		glBindVertexArray(0);
+		return 1;
+	}
+	for (const DrawElementsCommand& command : commands) {
+		const glm::vec3& offset = offsets[command.baseInstance];
+		glVertexAttrib3f(ATTR_OFFSET, offset.x, offset.y, offset.z);
+		glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, 
+								 (GLvoid*)(command.firstIndex * INDEX_BYTES), 
+								 command.baseVertex);
+	}
+	glBindVertexArray(0);
+	return commands.size();
+}
+
+bool GeometryArena::isIndirect() const {
+	return indirect;
+}
+
+size_t GeometryArena::getUsedBytes() const {
+	return vertices.getUsed() * VERTEX_BYTES + indices.getUsed() * INDEX_BYTES;
+}
+
+size_t GeometryArena::getCapacityBytes() const {
+	return vertices.getCapacity() * VERTEX_BYTES + indices.getCapacity() * INDEX_BYTES;
+}
@@ -0,0 +1,75 @@
+#ifndef GRAPHICS_GEOMETRY_ARENA_H_
+#define GRAPHICS_GEOMETRY_ARENA_H_
+
+#include <memory>
+#include "../typedefs.h"
+#include "ArenaAllocator.h"
+#include "ChunksDrawBatch.h"
+
+struct ChunkMeshData;
+class GeometryArena;
+
+/* Section geometry placed in GeometryArena, freed on destruction */
+class ArenaMesh {
+	GeometryArena* arena;
+	ArenaRange range;
+public:
+	ArenaMesh(GeometryArena* arena, ArenaRange range);
+	~ArenaMesh();
+
+	const ArenaRange& getRange() const;
+	/* Vertex and index buffers memory used */
+	size_t getBytes() const;
+};
+
+/* Chunk meshes geometry (see ChunkVertex.h) in one vertex and one index
+   buffer shared by all chunks, sub-allocated by ArenaAllocator and grown
+   when full. All sections of a frame are drawn with single
+   glMultiDrawElementsIndirect call where supported, per-section 
+   offsets are taken from instanced attribute (location 1) by
+   baseInstance. Otherwise each section is drawn with 
+   glDrawElementsBaseVertex and offset set as constant attribute.
+   Main thread only (GL context) */
+class GeometryArena {
+	uint vao;
+	uint vbo;
+	uint ibo;
+	/* Per-command offsets (instanced attribute) and commands buffers */
+	uint offsetsBuffer = 0;
+	uint commandsBuffer = 0;
+	size_t offsetsCapacity = 0;
+	size_t commandsCapacity = 0;
+	ArenaAllocator vertices;
+	ArenaAllocator indices;
+	bool indirect;
+
+	/* Move buffer contents to a new larger buffer */
+	void growBuffer(uint& buffer, size_t size, size_t capacity);
+	void growVertices(size_t capacity);
+	void growIndices(size_t capacity);
+	void setupAttributes();
+public:
+	/* @param vertexCapacity, indexCapacity initial buffers capacity
+	   @param indirect use multi-draw indirect if supported */
+	GeometryArena(size_t vertexCapacity, size_t indexCapacity, bool indirect);
+	~GeometryArena();
+
+	/* Place section geometry to the buffers
+	   @return nullptr if there is no geometry */
+	std::unique_ptr<ArenaMesh> upload(const ChunkMeshData& data);
+
+	void free(const ArenaRange& range);
+
+	/* Draw batch sections in order, main shader must be in use
+	   @return draw calls count */
+	size_t draw(const ChunksDrawBatch& batch);
+
+	/* @return true if batches are drawn with multi-draw indirect */
+	bool isIndirect() const;
+
+	/* Used and allocated buffers memory in bytes */
+	size_t getUsedBytes() const;
+	size_t getCapacityBytes() const;
+};
+
+#endif // GRAPHICS_GEOMETRY_ARENA_H_
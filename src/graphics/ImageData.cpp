@@ -1,4 +1,5 @@
 #include "ImageData.h"
+#include "../util/hashutil.h"
 
 #include <assert.h>
 #include <stdexcept>
@@ -303,3 +304,14 @@ ImageData* add_atlas_margins(ImageData* image, int grid_size) {
     }
     return new ImageData(image->getFormat(), dstwidth, dstheight, dstdata);
 }
+
+uint64_t hash_image(uint64_t hash, const ImageData* image) {
+    const uint width = image->getWidth();
+    const uint height = image->getHeight();
+    const ImageFormat format = image->getFormat();
+    const uint pixsize = format == ImageFormat::rgba8888 ? 4 : 3;
+    hash = util::hash_fnv1a(hash, &width, sizeof(width));
+    hash = util::hash_fnv1a(hash, &height, sizeof(height));
+    hash = util::hash_fnv1a(hash, &format, sizeof(format));
+    return util::hash_fnv1a(hash, image->getData(), width * height * pixsize);
+}
@@ -46,4 +46,7 @@ public:
 
 extern ImageData* add_atlas_margins(ImageData* image, int grid_size);
 
+/* Hash of image size, format and pixels (see util::hash_fnv1a) */
+extern uint64_t hash_image(uint64_t hash, const ImageData* image);
+
 #endif // GRAPHICS_IMAGE_DATA_H_
\ No newline at end of file
@@ -23,7 +23,14 @@ Mesh::Mesh(const float* vertexBuffer, size_t vertices, const int* indexBuffer, s
 	int offset = 0;
 	for (int i = 0; attrs[i].size; i++) {
 		int size = attrs[i].size;
-		glVertexAttribPointer(i, size, GL_FLOAT, GL_FALSE, vertexSize * sizeof(float), (GLvoid*)(offset * sizeof(float)));
+		switch (attrs[i].type) {
+			case vattr_type::u32:
+				glVertexAttribIPointer(i, size, GL_UNSIGNED_INT, vertexSize * sizeof(float), (GLvoid*)(offset * sizeof(float)));
+				break;
+			default:
+				glVertexAttribPointer(i, size, GL_FLOAT, GL_FALSE, vertexSize * sizeof(float), (GLvoid*)(offset * sizeof(float)));
+				break;
+		}
 		glEnableVertexAttribArray(i);
 		offset += size;
 	}
@@ -4,8 +4,17 @@
 #include <stdlib.h>
 #include "../typedefs.h"
 
+enum class vattr_type : ubyte {
+	/* float attribute */
+	f32,
+	/* unsigned int attribute, not converted (uint/uvec in shader) */
+	u32,
+};
+
+/* Vertex attribute, size is in 4-byte components */
 struct vattr {
 	ubyte size;
+	vattr_type type = vattr_type::f32;
 };
 
 class Mesh {
@@ -0,0 +1,183 @@
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../maths/FrustumCulling.h"
+#include "../maths/voxmaths.h"
+
+static_assert(CHUNK_W <= 16, "section row must fit uint16_t");
+
+const int SECTION_ROWS = CHUNK_SECTION_H * CHUNK_D;
+const uint16_t ROW_FULL = (1u << CHUNK_W) - 1;
+
+static const glm::ivec3 FACE_DIRECTIONS[occlusion::FACES] {
+	{-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}
+};
+
+/* Bit of faces pair a < b in connectivity */
+static inline int pair_bit(int a, int b) {
+	return a * 5 - a * (a - 1) / 2 + b - a - 1;
+}
+
+bool occlusion::connects(sconnect_t connectivity, int a, int b) {
+	if (a == b)
+		return true;
+	if (a > b)
+		std::swap(a, b);
+	return connectivity & (1 << pair_bit(a, b));
+}
+
+sconnect_t occlusion::compute_connectivity(const uint16_t* opaque) {
+	// visited voxels rows, opaque voxels are never visited
+	uint16_t visited[SECTION_ROWS];
+	bool empty = true;
+	bool full = true;
+	for (int i = 0; i < SECTION_ROWS; i++) {
+		visited[i] = opaque[i] & ROW_FULL;
+		empty &= visited[i] == 0;
+		full &= visited[i] == ROW_FULL;
+	}
+	if (empty)
+		return CONNECT_ALL;
+	if (full)
+		return 0;
+
+	uint16_t stack[SECTION_ROWS * CHUNK_W];
+	sconnect_t connectivity = 0;
+	for (int seedRow = 0; seedRow < SECTION_ROWS; seedRow++) {
+		for (int seedX = 0; seedX < CHUNK_W; seedX++) {
+			if (visited[seedRow] & (1 << seedX))
+				continue;
+			// flood fill of open voxels region, faces touched are connected
+			visited[seedRow] |= 1 << seedX;
+			int size = 0;
+			stack[size++] = seedRow * CHUNK_W + seedX;
+			int faces = 0;
+			while (size) {
+				const int index = stack[--size];
+				const int x = index % CHUNK_W;
+				const int row = index / CHUNK_W;
+				const int y = row / CHUNK_D;
+				const int z = row % CHUNK_D;
+				if (x == 0) faces |= 1 << 0;
+				if (x == CHUNK_W - 1) faces |= 1 << 1;
+				if (y == 0) faces |= 1 << 2;
+				if (y == CHUNK_SECTION_H - 1) faces |= 1 << 3;
+				if (z == 0) faces |= 1 << 4;
+				if (z == CHUNK_D - 1) faces |= 1 << 5;
+
+				auto visit = [&](int nx, int nrow) {
+					if (!(visited[nrow] & (1 << nx))) {
+						visited[nrow] |= 1 << nx;
+						stack[size++] = nrow * CHUNK_W + nx;
+					}
+				};
+				if (x > 0) visit(x - 1, row);
+				if (x < CHUNK_W - 1) visit(x + 1, row);
+				if (y > 0) visit(x, row - CHUNK_D);
+				if (y < CHUNK_SECTION_H - 1) visit(x, row + CHUNK_D);
+				if (z > 0) visit(x, row - 1);
+				if (z < CHUNK_D - 1) visit(x, row + 1);
+			}
+			for (int a = 0; a < FACES; a++) {
+				if (!(faces & (1 << a)))
+					continue;
+				for (int b = a + 1; b < FACES; b++) {
+					if (faces & (1 << b))
+						connectivity |= 1 << pair_bit(a, b);
+				}
+			}
+			if (connectivity == CONNECT_ALL)
+				return connectivity;
+		}
+	}
+	return connectivity;
+}
+
+void OcclusionCuller::setArea(int w, int d, int ox, int oz) {
+	this->w = w;
+	this->d = d;
+	this->ox = ox;
+	this->oz = oz;
+	graph.assign(w * d * CHUNK_SECTIONS, occlusion::CONNECT_ALL);
+	visibleSections.assign(w * d * CHUNK_SECTIONS, 0);
+	visibleChunks.assign(w * d, 0);
+}
+
+void OcclusionCuller::setChunk(int x, int z, const sconnect_t* sections) {
+	sconnect_t* dst = graph.data() + (z * w + x) * CHUNK_SECTIONS;
+	if (sections == nullptr) {
+		std::fill(dst, dst + CHUNK_SECTIONS, occlusion::CONNECT_ALL);
+	} else {
+		std::copy(sections, sections + CHUNK_SECTIONS, dst);
+	}
+}
+
+void OcclusionCuller::update(const glm::vec3& camera, const Frustum* frustum) {
+	std::fill(visibleSections.begin(), visibleSections.end(), 0);
+	std::fill(visibleChunks.begin(), visibleChunks.end(), 0);
+	visibleCount = 0;
+	queue.clear();
+
+	const int cx = floordiv(int(std::floor(camera.x)), CHUNK_W) - ox;
+	const int cz = floordiv(int(std::floor(camera.z)), CHUNK_D) - oz;
+	if (cx < 0 || cz < 0 || cx >= w || cz >= d) {
+		// camera is out of area, nothing occludes anything
+		std::fill(visibleSections.begin(), visibleSections.end(), 1);
+		std::fill(visibleChunks.begin(), visibleChunks.end(), 1);
+		visibleCount = visibleSections.size();
+		return;
+	}
+	// camera above or below the world sees the nearest section first
+	int cy = int(std::floor(camera.y / CHUNK_SECTION_H));
+	cy = std::min(std::max(cy, 0), CHUNK_SECTIONS - 1);
+
+	auto index = [this](int x, int y, int z) {
+		return (z * w + x) * CHUNK_SECTIONS + y;
+	};
+	visibleSections[index(cx, cy, cz)] = 1;
+	queue.push_back({int16_t(cx), int16_t(cy), int16_t(cz), -1, 0});
+	for (size_t next = 0; next < queue.size(); next++) {
+		const Step step = queue[next];
+		const sconnect_t connectivity = graph[index(step.x, step.y, step.z)];
+		visibleChunks[step.z * w + step.x] = 1;
+		visibleCount++;
+		for (int face = 0; face < occlusion::FACES; face++) {
+			if (step.directions & (1 << (face ^ 1)))
+				continue;
+			if (step.face >= 0 && !occlusion::connects(connectivity, step.face, face))
+				continue;
+			const glm::ivec3& dir = FACE_DIRECTIONS[face];
+			const int x = step.x + dir.x;
+			const int y = step.y + dir.y;
+			const int z = step.z + dir.z;
+			if (x < 0 || y < 0 || z < 0 || x >= w || y >= CHUNK_SECTIONS || z >= d)
+				continue;
+			ubyte& visible = visibleSections[index(x, y, z)];
+			if (visible)
+				continue;
+			if (frustum) {
+				glm::vec3 min((x + ox) * CHUNK_W, y * CHUNK_SECTION_H, (z + oz) * CHUNK_D);
+				glm::vec3 max = min + glm::vec3(CHUNK_W, CHUNK_SECTION_H, CHUNK_D);
+				if (!frustum->IsBoxVisible(min, max))
+					continue;
+			}
+			visible = 1;
+			queue.push_back({int16_t(x), int16_t(y), int16_t(z),
+							 int8_t(face ^ 1), ubyte(step.directions | (1 << face))});
+		}
+	}
+}
+
+bool OcclusionCuller::isVisible(int x, int y, int z) const {
+	return visibleSections[(z * w + x) * CHUNK_SECTIONS + y];
+}
+
+bool OcclusionCuller::isVisible(int x, int z) const {
+	return visibleChunks[z * w + x];
+}
+
+size_t OcclusionCuller::getVisibleCount() const {
+	return visibleCount;
+}
@@ -0,0 +1,84 @@
+#ifndef GRAPHICS_OCCLUSION_CULLING_H_
+#define GRAPHICS_OCCLUSION_CULLING_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "../typedefs.h"
+#include "../constants.h"
+
+class Frustum;
+
+/* Chunk section faces connectivity: bit per pair of section faces
+   connected through non-opaque voxels of the section */
+typedef uint16_t sconnect_t;
+
+/* Section faces are indexed -x, +x, -y, +y, -z, +z,
+   so the opposite face is face ^ 1 */
+namespace occlusion {
+	const int FACES = 6;
+	/* All faces are connected (section has no opaque voxels) */
+	const sconnect_t CONNECT_ALL = 0x7FFF;
+
+	/* Faces connectivity of a section
+	   @param opaque CHUNK_SECTION_H * CHUNK_D rows of voxels,
+	   row index is y * CHUNK_D + z, bit x is set if the voxel is opaque */
+	sconnect_t compute_connectivity(const uint16_t* opaque);
+
+	/* @return true if faces a and b are connected */
+	bool connects(sconnect_t connectivity, int a, int b);
+}
+
+/* Visible chunk sections search, headless (no GL). Sections graph of the
+   chunks area is traversed breadth-first from the camera section:
+   a section is entered through a face and left through faces connected
+   to it, never moving back towards the camera, so sections behind
+   terrain or in closed caves are not reached */
+class OcclusionCuller {
+	/* Area size and position in chunks (same as Chunks area) */
+	int w = 0;
+	int d = 0;
+	int ox = 0;
+	int oz = 0;
+	/* Connectivity of sections, index is (z * w + x) * CHUNK_SECTIONS + y */
+	std::vector<sconnect_t> graph;
+	std::vector<ubyte> visibleSections;
+	/* Chunk has at least one visible section, index is z * w + x */
+	std::vector<ubyte> visibleChunks;
+	size_t visibleCount = 0;
+
+	struct Step {
+		int16_t x, y, z;
+		/* Face the section is entered through, -1 for camera section */
+		int8_t face;
+		/* Directions taken from camera section (bit per face) */
+		ubyte directions;
+	};
+	std::vector<Step> queue;
+public:
+	/* Set chunks area, connectivity of all sections is reset to open */
+	void setArea(int w, int d, int ox, int oz);
+
+	/* Set connectivity of chunk sections
+	   @param x, z chunk position in the area
+	   @param sections CHUNK_SECTIONS values or nullptr if chunk
+	   has no mesh (sections are considered open) */
+	void setChunk(int x, int z, const sconnect_t* sections);
+
+	/* Find visible sections
+	   @param camera camera position in world
+	   @param frustum sections out of frustum are not visited (optional) */
+	void update(const glm::vec3& camera, const Frustum* frustum);
+
+	/* @param x, z chunk position in the area
+	   @param y section index */
+	bool isVisible(int x, int y, int z) const;
+
+	/* @return true if any section of the chunk is visible
+	   @param x, z chunk position in the area */
+	bool isVisible(int x, int z) const;
+
+	/* Visible sections count of the last update */
+	size_t getVisibleCount() const;
+};
+
+#endif // GRAPHICS_OCCLUSION_CULLING_H_
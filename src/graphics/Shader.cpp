@@ -4,6 +4,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <string.h>
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -20,8 +21,42 @@ using std::string;
 using std::filesystem::path;
 
 GLSLExtension* Shader::preprocessor = new GLSLExtension();
+size_t Shader::uniformUploads = 0;
+size_t Shader::uniformSkips = 0;
+size_t Shader::frameUniformUploads = 0;
+size_t Shader::frameUniformSkips = 0;
+
+void Shader::nextFrame() {
+	frameUniformUploads = uniformUploads;
+	frameUniformSkips = uniformSkips;
+	uniformUploads = 0;
+	uniformSkips = 0;
+}
 
 Shader::Shader(unsigned int id) : id(id){
+	GLint count = 0;
+	GLint maxLength = 0;
+	glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::vector<GLchar> buffer(maxLength + 1);
+	for (GLint i = 0; i < count; i++) {
+		GLsizei length = 0;
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(id, i, buffer.size(), &length, &size, &type, buffer.data());
+		string name(buffer.data(), length);
+		GLint location = glGetUniformLocation(id, name.c_str());
+		if (location < 0)
+			continue;
+		uniformid_t uniform = uniforms.size();
+		uniforms.push_back(Uniform {location, false, {}});
+		uniformsMap[name] = uniform;
+		// arrays are listed as name[0]
+		size_t bracket = name.find('[');
+		if (bracket != string::npos) {
+			uniformsMap[name.substr(0, bracket)] = uniform;
+		}
+	}
 }
 
 Shader::~Shader(){
@@ -32,39 +67,84 @@ void Shader::use(){
 	glUseProgram(id);
 }
 
-void Shader::uniformMatrix(string name, glm::mat4 matrix){
-	GLuint transformLoc = glGetUniformLocation(id, name.c_str());
-	glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(matrix));
+uniformid_t Shader::getUniform(const string& name) const {
+	auto found = uniformsMap.find(name);
+	if (found == uniformsMap.end()) {
+		return -1;
+	}
+	return found->second;
+}
+
+bool Shader::update(uniformid_t uniform, const void* value, size_t size) {
+	if (uniform < 0)
+		return false;
+	Uniform& entry = uniforms[uniform];
+	if (entry.assigned && memcmp(entry.value, value, size) == 0) {
+		uniformSkips++;
+		return false;
+	}
+	memcpy(entry.value, value, size);
+	entry.assigned = true;
+	uniformUploads++;
+	return true;
+}
+
+void Shader::uniformMatrix(uniformid_t uniform, const glm::mat4& matrix){
+	if (update(uniform, glm::value_ptr(matrix), sizeof(glm::mat4))) {
+		glUniformMatrix4fv(uniforms[uniform].location, 1, GL_FALSE, glm::value_ptr(matrix));
+	}
+}
+
+void Shader::uniform1i(uniformid_t uniform, int x){
+	if (update(uniform, &x, sizeof(x))) {
+		glUniform1i(uniforms[uniform].location, x);
+	}
+}
+
+void Shader::uniform1f(uniformid_t uniform, float x){
+	if (update(uniform, &x, sizeof(x))) {
+		glUniform1f(uniforms[uniform].location, x);
+	}
+}
+
+void Shader::uniform2f(uniformid_t uniform, const vec2& xy){
+	if (update(uniform, glm::value_ptr(xy), sizeof(vec2))) {
+		glUniform2f(uniforms[uniform].location, xy.x, xy.y);
+	}
+}
+
+void Shader::uniform3f(uniformid_t uniform, const vec3& xyz){
+	if (update(uniform, glm::value_ptr(xyz), sizeof(vec3))) {
+		glUniform3f(uniforms[uniform].location, xyz.x, xyz.y, xyz.z);
+	}
+}
+
+void Shader::uniformMatrix(const string& name, const glm::mat4& matrix){
+	uniformMatrix(getUniform(name), matrix);
 }
 
-void Shader::uniform1i(string name, int x){
-	GLuint transformLoc = glGetUniformLocation(id, name.c_str());
-	glUniform1i(transformLoc, x);
+void Shader::uniform1i(const string& name, int x){
+	uniform1i(getUniform(name), x);
 }
 
-void Shader::uniform1f(string name, float x){
-	GLuint transformLoc = glGetUniformLocation(id, name.c_str());
-	glUniform1f(transformLoc, x);
+void Shader::uniform1f(const string& name, float x){
+	uniform1f(getUniform(name), x);
 }
 
-void Shader::uniform2f(string name, float x, float y){
-	GLuint transformLoc = glGetUniformLocation(id, name.c_str());
-	glUniform2f(transformLoc, x, y);
+void Shader::uniform2f(const string& name, float x, float y){
+	uniform2f(getUniform(name), vec2(x, y));
 }
 
-void Shader::uniform2f(string name, vec2 xy){
-	GLuint transformLoc = glGetUniformLocation(id, name.c_str());
-	glUniform2f(transformLoc, xy.x, xy.y);
+void Shader::uniform2f(const string& name, const vec2& xy){
+	uniform2f(getUniform(name), xy);
 }
 
-void Shader::uniform3f(string name, float x, float y, float z){
-	GLuint transformLoc = glGetUniformLocation(id, name.c_str());
-	glUniform3f(transformLoc, x,y,z);
+void Shader::uniform3f(const string& name, float x, float y, float z){
+	uniform3f(getUniform(name), vec3(x, y, z));
 }
 
-void Shader::uniform3f(string name, vec3 xyz){
-	GLuint transformLoc = glGetUniformLocation(id, name.c_str());
-	glUniform3f(transformLoc, xyz.x, xyz.y, xyz.z);
+void Shader::uniform3f(const string& name, const vec3& xyz){
+	uniform3f(getUniform(name), xyz);
 }
 
 
@@ -2,26 +2,66 @@
 #define GRAPHICS_SHADER_H_
 
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include <glm/glm.hpp>
 
 class GLSLExtension;
 
+/* Uniform handle of a shader (see Shader::getUniform), -1 if the shader
+   has no such active uniform (setting it does nothing) */
+typedef int uniformid_t;
+
 class Shader {
+	/* Active uniform with the last value set (values are kept by
+	   program, so unchanged values are not uploaded again) */
+	struct Uniform {
+		int location;
+		bool assigned = false;
+		float value[16];
+	};
+	std::vector<Uniform> uniforms;
+	std::unordered_map<std::string, uniformid_t> uniformsMap;
+
+	/* @return true if the uniform value must be uploaded */
+	bool update(uniformid_t uniform, const void* value, size_t size);
 public:
 	static GLSLExtension* preprocessor;
+	/* Uniform values uploaded and skipped as unchanged 
+	   during the current frame */
+	static size_t uniformUploads;
+	static size_t uniformSkips;
+	/* Uniform uploads and skips of the last frame (debug info) */
+	static size_t frameUniformUploads;
+	static size_t frameUniformSkips;
+
+	/* Called by engine once per frame */
+	static void nextFrame();
 	unsigned int id;
 
+	/* Active uniforms locations are resolved here
+	   @param id linked program */
 	Shader(unsigned int id);
 	~Shader();
 
 	void use();
-	void uniformMatrix(std::string name, glm::mat4 matrix);
-	void uniform1i(std::string name, int x);
-	void uniform1f(std::string name, float x);
-	void uniform2f(std::string name, float x, float y);
-	void uniform2f(std::string name, glm::vec2 xy);
-	void uniform3f(std::string name, float x, float y, float z);
-	void uniform3f(std::string name, glm::vec3 xyz);
+
+	/* Resolve uniform once to set it in hot paths without name lookup */
+	uniformid_t getUniform(const std::string& name) const;
+
+	void uniformMatrix(uniformid_t uniform, const glm::mat4& matrix);
+	void uniform1i(uniformid_t uniform, int x);
+	void uniform1f(uniformid_t uniform, float x);
+	void uniform2f(uniformid_t uniform, const glm::vec2& xy);
+	void uniform3f(uniformid_t uniform, const glm::vec3& xyz);
+
+	void uniformMatrix(const std::string& name, const glm::mat4& matrix);
+	void uniform1i(const std::string& name, int x);
+	void uniform1f(const std::string& name, float x);
+	void uniform2f(const std::string& name, float x, float y);
+	void uniform2f(const std::string& name, const glm::vec2& xy);
+	void uniform3f(const std::string& name, float x, float y, float z);
+	void uniform3f(const std::string& name, const glm::vec3& xyz);
 
 	static Shader* loadShader(std::string vertexFile, std::string fragmentFile,
 						std::string vertexSource, std::string fragmentSource);
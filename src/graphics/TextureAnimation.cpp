@@ -3,7 +3,7 @@
 #include "Framebuffer.h"
 
 #include <GL/glew.h>
-#include <unordered_set>
+#include <algorithm>
 
 TextureAnimator::TextureAnimator() {
     glGenFramebuffers(1, &fboR);
@@ -21,65 +21,100 @@ void TextureAnimator::addAnimations(const std::vector<TextureAnimation>& animati
     }
 }
 
-void TextureAnimator::update(float delta) {
-    std::unordered_set<uint> changedTextures;
+bool TextureAnimation::advance(float delta) {
+    if (frames.empty()) {
+        return false;
+    }
+    size_t frameNum = currentFrame;
+    // zero duration frames are skipped, so steps without time spent
+    // are counted to stop animations having no other frames
+    size_t skipped = 0;
+    timer += delta;
+    while (timer >= frames[currentFrame].duration) {
+        float duration = std::max(frames[currentFrame].duration, 0.0f);
+        if (duration == 0.0f && ++skipped > frames.size()) {
+            timer = 0.0f;
+            break;
+        } else if (duration > 0.0f) {
+            skipped = 0;
+        }
+        timer -= duration;
+        currentFrame++;
+        if (currentFrame >= frames.size()) currentFrame = 0;
+    }
+    return frameNum != currentFrame;
+}
 
+void TextureAnimator::schedule(std::vector<TextureAnimation>& animations, 
+                               float delta, std::vector<FrameBlit>& blits) {
+    blits.clear();
     for (auto& elem : animations) {
-        elem.timer += delta;
-        size_t frameNum = elem.currentFrame;
-        Frame frame = elem.frames[elem.currentFrame];
-        while (elem.timer >= frame.duration) {
-            elem.timer -= frame.duration;
-            elem.currentFrame++;
-            if (elem.currentFrame >= elem.frames.size()) elem.currentFrame = 0;
-            frame = elem.frames[elem.currentFrame];
+        if (elem.advance(delta)) {
+            blits.push_back({
+                elem.srcTexture, elem.dstTexture, &elem.frames[elem.currentFrame]
+            });
         }
-        if (frameNum != elem.currentFrame){
-            if (changedTextures.find(elem.dstTexture->id) == changedTextures.end()) changedTextures.insert(elem.dstTexture->id);
-
-            glBindFramebuffer(GL_FRAMEBUFFER, fboD);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, elem.dstTexture->id, 0);
-
-            glBindFramebuffer(GL_FRAMEBUFFER, fboR);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, elem.srcTexture->id, 0);
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    // framebuffers attachments are changed once per textures pair
+    std::stable_sort(blits.begin(), blits.end(), [](const FrameBlit& a, const FrameBlit& b) {
+        if (a.dstTexture->id != b.dstTexture->id) 
+            return a.dstTexture->id < b.dstTexture->id;
+        return a.srcTexture->id < b.srcTexture->id;
+    });
+}
 
-            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fboD);
-            glBindFramebuffer(GL_READ_FRAMEBUFFER, fboR);
+void TextureAnimator::update(float delta) {
+    schedule(animations, delta, blits);
+    if (blits.empty()) {
+        return;
+    }
 
-            float srcPosY = elem.srcTexture->height - frame.size.y - frame.srcPos.y; // vertical flip
+    Texture* srcTexture = nullptr;
+    Texture* dstTexture = nullptr;
+    std::vector<uint> changedTextures;
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fboD);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fboR);
+    for (const auto& blit : blits) {
+        if (blit.dstTexture != dstTexture) {
+            dstTexture = blit.dstTexture;
+            changedTextures.push_back(dstTexture->id);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dstTexture->id, 0);
+        }
+        if (blit.srcTexture != srcTexture) {
+            srcTexture = blit.srcTexture;
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, srcTexture->id, 0);
+        }
+        const Frame& frame = *blit.frame;
+        float srcPosY = srcTexture->height - frame.size.y - frame.srcPos.y; // vertical flip
 
-            // Extensions
-            const int ext = 2;
-            for (int y = -1; y <= 1; y++) {
-                for (int x = -1; x <= 1; x++) {
-                    if (x == 0 && y == 0)
-                        continue;
-                    glBlitFramebuffer(
-                        frame.srcPos.x, srcPosY, frame.srcPos.x + frame.size.x, srcPosY + frame.size.y,
-                        frame.dstPos.x+x*ext, frame.dstPos.y+y*ext,	
-                        frame.dstPos.x + frame.size.x+x*ext, frame.dstPos.y + frame.size.y+y*ext,
-                        GL_COLOR_BUFFER_BIT, GL_NEAREST
-                    );
-                }
+        // Extensions
+        const int ext = 2;
+        for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++) {
+                if (x == 0 && y == 0)
+                    continue;
+                glBlitFramebuffer(
+                    frame.srcPos.x, srcPosY, frame.srcPos.x + frame.size.x, srcPosY + frame.size.y,
+                    frame.dstPos.x+x*ext, frame.dstPos.y+y*ext,	
+                    frame.dstPos.x + frame.size.x+x*ext, frame.dstPos.y + frame.size.y+y*ext,
+                    GL_COLOR_BUFFER_BIT, GL_NEAREST
+                );
             }
-
-            glBlitFramebuffer(
-                frame.srcPos.x, srcPosY,
-                frame.srcPos.x + frame.size.x,	
-                srcPosY + frame.size.y,
-                frame.dstPos.x, frame.dstPos.y,	
-                frame.dstPos.x + frame.size.x,
-                frame.dstPos.y + frame.size.y,
-                GL_COLOR_BUFFER_BIT, GL_NEAREST
-            );
         }
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+        glBlitFramebuffer(
+            frame.srcPos.x, srcPosY,
+            frame.srcPos.x + frame.size.x,	
+            srcPosY + frame.size.y,
+            frame.dstPos.x, frame.dstPos.y,	
+            frame.dstPos.x + frame.size.x,
+            frame.dstPos.y + frame.size.y,
+            GL_COLOR_BUFFER_BIT, GL_NEAREST
+        );
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    for (auto& elem : changedTextures) {
-        glBindTexture(GL_TEXTURE_2D, elem);
+    for (uint texture : changedTextures) {
+        glBindTexture(GL_TEXTURE_2D, texture);
         glGenerateMipmap(GL_TEXTURE_2D);
     }
     glBindTexture(GL_TEXTURE_2D, 0);
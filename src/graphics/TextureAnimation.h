@@ -26,6 +26,10 @@ public:
 
     void addFrame(const Frame& frame) { frames.emplace_back(frame); };
 
+    /* Advance the timer
+       @return true if the current frame is changed */
+    bool advance(float delta);
+
     size_t currentFrame = 0;
     float timer = 0.f;
     Texture* srcTexture;
@@ -33,6 +37,13 @@ public:
     std::vector<Frame> frames;
 };
 
+/* Frame region copy to the destination texture */
+struct FrameBlit {
+    Texture* srcTexture;
+    Texture* dstTexture;
+    const Frame* frame;
+};
+
 class TextureAnimator {
 public:
     TextureAnimator();
@@ -41,12 +52,20 @@ public:
     void addAnimation(const TextureAnimation& animation) { animations.emplace_back(animation); };
     void addAnimations(const std::vector<TextureAnimation>& animations);
 
+    /* Blit frames changed, nothing is done if no frame is changed */
     void update(float delta);
+
+    /* Advance animations and collect frames to blit (no GL calls)
+       @param blits frames changed, grouped by destination and source 
+       textures (blits are cleared first) */
+    static void schedule(std::vector<TextureAnimation>& animations, 
+                         float delta, std::vector<FrameBlit>& blits);
 private:
     uint fboR;
     uint fboD;
 
     std::vector<TextureAnimation> animations;
+    std::vector<FrameBlit> blits;
 };
 
 #endif // !TEXTURE_ANIMATION_H
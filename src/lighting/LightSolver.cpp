@@ -21,7 +21,7 @@ void LightSolver::add(int x, int y, int z, int emission) {
 	addqueue.push(lightentry {x, y, z, ubyte(emission)});
 
 	Chunk* chunk = chunks->getChunkByVoxel(x, y, z);
-	chunk->setModified(true);
+	chunk->setModifiedAt(y);
 	chunk->lightmap.set(x-chunk->x*CHUNK_W, y, z-chunk->z*CHUNK_D, channel, emission);
 }
 
@@ -53,6 +53,7 @@ void LightSolver::solve(){
 		   -1, 0, 0
 	};
 
+	const Block* const* blockDefs = contentIds->getBlockDefs();
 	while (!remqueue.empty()){
 		const lightentry entry = remqueue.front();
 		remqueue.pop();
@@ -65,12 +66,22 @@ void LightSolver::solve(){
 			if (chunk) {
 				int lx = x - chunk->x * CHUNK_W;
 				int lz = z - chunk->z * CHUNK_D;
-				chunk->setModified(true);
+				chunk->setModifiedAt(y);
 
 				ubyte light = chunk->lightmap.get(lx,y,lz, channel);
-				if (light != 0 && light == entry.light-1){
+				if (light != 0 && light < entry.light){
 					remqueue.push(lightentry {x, y, z, light});
 					chunk->lightmap.set(lx, y, lz, channel, 0);
+
+					// emitters keep their own light
+					if (channel < 3) {
+						voxel& v = chunk->voxels[vox_index(lx, y, lz)];
+						ubyte emission = blockDefs[v.id]->emission[channel];
+						if (emission > 1) {
+							chunk->lightmap.set(lx, y, lz, channel, emission);
+							addqueue.push(lightentry {x, y, z, emission});
+						}
+					}
 				}
 				else if (light >= entry.light){
 					addqueue.push(lightentry {x, y, z, light});
@@ -79,11 +90,14 @@ void LightSolver::solve(){
 		}
 	}
 
-	const Block* const* blockDefs = contentIds->getBlockDefs();
 	while (!addqueue.empty()){
 		const lightentry entry = addqueue.front();
 		addqueue.pop();
 
+		// skipping entries cleared by removal after being queued
+		if (chunks->getLight(entry.x, entry.y, entry.z, channel) != entry.light)
+			continue;
+
 		for (int i = 0; i < 6; i++) {
 			int x = entry.x+coords[i*3+0];
 			int y = entry.y+coords[i*3+1];
@@ -92,7 +106,7 @@ void LightSolver::solve(){
 			if (chunk) {
 				int lx = x - chunk->x * CHUNK_W;
 				int lz = z - chunk->z * CHUNK_D;
-				chunk->setModified(true);
+				chunk->setModifiedAt(y);
 
 				ubyte light = chunk->lightmap.get(lx, y, lz, channel);
 				voxel& v = chunk->voxels[vox_index(lx, y, lz)];
@@ -1,4 +1,5 @@
 #include <memory>
+#include <algorithm>
 
 #include "Lighting.h"
 #include "LightSolver.h"
@@ -11,6 +12,7 @@
 #include "../constants.h"
 #include "../typedefs.h"
 #include "../util/timeutil.h"
+#include "../devtools/profiler.h"
 
 Lighting::Lighting(const Content* content, Chunks* chunks) 
 	     : content(content), chunks(chunks) {
@@ -36,21 +38,16 @@ void Lighting::clear(){
 	}
 }
 
-void Lighting::prebuildSkyLight(Chunk* chunk, const ContentIndices* indices){
-	auto* blockDefs = indices->getBlockDefs();
+void Lighting::prebuildSkyLight(Chunk* chunk){
+	const Heightmap& heightmap = chunk->heightmap;
 
 	int highestPoint = 0;
 	for (int z = 0; z < CHUNK_D; z++){
 		for (int x = 0; x < CHUNK_W; x++){
-			for (int y = CHUNK_H-1; y >= 0; y--){
-                int index = (y * CHUNK_D + z) * CHUNK_W + x;
-				voxel& vox = chunk->voxels[index];
-				const Block* block = blockDefs[vox.id];
-				if (!block->skyLightPassing) {
-					if (highestPoint < y)
-						highestPoint = y;
-					break;
-				}
+			int opaqueHeight = heightmap.getOpaque(x, z);
+			if (highestPoint < opaqueHeight-1)
+				highestPoint = opaqueHeight-1;
+			for (int y = CHUNK_H-1; y >= opaqueHeight; y--){
 				chunk->lightmap.setS(x,y,z, 15);
 			}
 		}
@@ -61,6 +58,7 @@ void Lighting::prebuildSkyLight(Chunk* chunk, const ContentIndices* indices){
 }
 
 void Lighting::buildSkyLight(int cx, int cz){
+	profiler::Scope scope("Lighting::buildSkyLight");
 	const Block* const* blockDefs = content->getIndices()->getBlockDefs();
 
 	Chunk* chunk = chunks->getChunk(cx, cz);
@@ -88,6 +86,7 @@ void Lighting::buildSkyLight(int cx, int cz){
 }
 
 void Lighting::onChunkLoaded(int cx, int cz, bool expand){
+	profiler::Scope scope("Lighting::onChunkLoaded");
     LightSolver* solverR = this->solverR.get();
     LightSolver* solverG = this->solverG.get();
     LightSolver* solverB = this->solverB.get();
@@ -96,88 +95,110 @@ void Lighting::onChunkLoaded(int cx, int cz, bool expand){
 	const Block* const* blockDefs = content->getIndices()->getBlockDefs();
 	const Chunk* chunk = chunks->getChunk(cx, cz);
 
-	for (uint y = 0; y < CHUNK_H; y++){
-		for (uint z = 0; z < CHUNK_D; z++){
-			for (uint x = 0; x < CHUNK_W; x++){
-				const voxel& vox = chunk->voxels[(y * CHUNK_D + z) * CHUNK_W + x];
-				const Block* block = blockDefs[vox.id];
-				int gx = x + cx * CHUNK_W;
-				int gz = z + cz * CHUNK_D;
-				if (block->rt.emissive){
-					solverR->add(gx,y,gz,block->emission[0]);
-					solverG->add(gx,y,gz,block->emission[1]);
-					solverB->add(gx,y,gz,block->emission[2]);
-				}
-			}
-		}
+	for (uint index : chunk->emitters.getIndices()){
+		const Block* block = blockDefs[chunk->voxels[index].id];
+		int gx = index % CHUNK_W + cx * CHUNK_W;
+		int gz = index / CHUNK_W % CHUNK_D + cz * CHUNK_D;
+		int y = index / (CHUNK_W * CHUNK_D);
+		solverR->add(gx,y,gz,block->emission[0]);
+		solverG->add(gx,y,gz,block->emission[1]);
+		solverB->add(gx,y,gz,block->emission[2]);
 	}
 
 	if (expand) {
-		for (int x = 0; x < CHUNK_W; x += CHUNK_W-1) {
-			for (int y = 0; y < CHUNK_H; y++) {
-				for (int z = 0; z < CHUNK_D; z++) {
-					int gx = x + cx * CHUNK_W;
-					int gz = z + cz * CHUNK_D;
-					int rgbs = chunk->lightmap.get(x, y, z);
-					if (rgbs){
-						solverR->add(gx,y,gz, Lightmap::extract(rgbs, 0));
-						solverG->add(gx,y,gz, Lightmap::extract(rgbs, 1));
-						solverB->add(gx,y,gz, Lightmap::extract(rgbs, 2));
-						solverS->add(gx,y,gz, Lightmap::extract(rgbs, 3));
-					}
+		addBorderLights(chunk);
+	}
+	solverR->solve();
+	solverG->solve();
+	solverB->solve();
+	solverS->solve();
+}
+
+void Lighting::addBorderLights(const Chunk* chunk) {
+	int cx = chunk->x;
+	int cz = chunk->z;
+	for (int x = 0; x < CHUNK_W; x += CHUNK_W-1) {
+		for (int y = 0; y < CHUNK_H; y++) {
+			for (int z = 0; z < CHUNK_D; z++) {
+				int gx = x + cx * CHUNK_W;
+				int gz = z + cz * CHUNK_D;
+				int rgbs = chunk->lightmap.get(x, y, z);
+				if (rgbs){
+					solverR->add(gx,y,gz, Lightmap::extract(rgbs, 0));
+					solverG->add(gx,y,gz, Lightmap::extract(rgbs, 1));
+					solverB->add(gx,y,gz, Lightmap::extract(rgbs, 2));
+					solverS->add(gx,y,gz, Lightmap::extract(rgbs, 3));
 				}
 			}
 		}
-		for (int z = 0; z < CHUNK_D; z += CHUNK_D-1) {
-			for (int y = 0; y < CHUNK_H; y++) {
-				for (int x = 0; x < CHUNK_W; x++) {
-					int gx = x + cx * CHUNK_W;
-					int gz = z + cz * CHUNK_D;
-					int rgbs = chunk->lightmap.get(x, y, z);
-					if (rgbs){
-						solverR->add(gx,y,gz, Lightmap::extract(rgbs, 0));
-						solverG->add(gx,y,gz, Lightmap::extract(rgbs, 1));
-						solverB->add(gx,y,gz, Lightmap::extract(rgbs, 2));
-						solverS->add(gx,y,gz, Lightmap::extract(rgbs, 3));
-					}
+	}
+	for (int z = 0; z < CHUNK_D; z += CHUNK_D-1) {
+		for (int y = 0; y < CHUNK_H; y++) {
+			for (int x = 0; x < CHUNK_W; x++) {
+				int gx = x + cx * CHUNK_W;
+				int gz = z + cz * CHUNK_D;
+				int rgbs = chunk->lightmap.get(x, y, z);
+				if (rgbs){
+					solverR->add(gx,y,gz, Lightmap::extract(rgbs, 0));
+					solverG->add(gx,y,gz, Lightmap::extract(rgbs, 1));
+					solverB->add(gx,y,gz, Lightmap::extract(rgbs, 2));
+					solverS->add(gx,y,gz, Lightmap::extract(rgbs, 3));
 				}
 			}
 		}
 	}
+}
+
+void Lighting::onCachedChunkLoaded(int cx, int cz) {
+	profiler::Scope scope("Lighting::onCachedChunkLoaded");
+	addBorderLights(chunks->getChunk(cx, cz));
 	solverR->solve();
 	solverG->solve();
 	solverB->solve();
 	solverS->solve();
 }
 
-void Lighting::onBlockSet(int x, int y, int z, blockid_t id){
-	Block* block = content->getIndices()->getBlockDef(id);
-	if (id == 0){
-		solverR->remove(x,y,z);
-		solverG->remove(x,y,z);
-		solverB->remove(x,y,z);
-		solverR->solve();
-		solverG->solve();
-		solverB->solve();
-		if (chunks->getLight(x,y+1,z, 3) == 0xF){
-			for (int i = y; i >= 0; i--){
-				voxel* vox = chunks->get(x,i,z);
-				if ((vox == nullptr || vox->id != 0) && block->skyLightPassing)
-					break;
-				solverS->add(x,i,z, 0xF);
-			}
-		}
-		solverR->add(x,y+1,z); solverG->add(x,y+1,z); solverB->add(x,y+1,z); solverS->add(x,y+1,z);
-		solverR->add(x,y-1,z); solverG->add(x,y-1,z); solverB->add(x,y-1,z); solverS->add(x,y-1,z);
-		solverR->add(x+1,y,z); solverG->add(x+1,y,z); solverB->add(x+1,y,z); solverS->add(x+1,y,z);
-		solverR->add(x-1,y,z); solverG->add(x-1,y,z); solverB->add(x-1,y,z); solverS->add(x-1,y,z);
-		solverR->add(x,y,z+1); solverG->add(x,y,z+1); solverB->add(x,y,z+1); solverS->add(x,y,z+1);
-		solverR->add(x,y,z-1); solverG->add(x,y,z-1); solverB->add(x,y,z-1); solverS->add(x,y,z-1);
-		solverR->solve();
-		solverG->solve();
-		solverB->solve();
-		solverS->solve();
-	} else {
+void Lighting::beginBatch() {
+	batchDepth++;
+}
+
+void Lighting::endBatch() {
+	if (batchDepth > 0 && --batchDepth == 0) {
+		solveBatch();
+	}
+}
+
+void Lighting::onBlockSet(int x, int y, int z) {
+	batch.push_back(glm::ivec3(x, y, z));
+	if (batchDepth == 0) {
+		solveBatch();
+	}
+}
+
+void Lighting::solveBatch() {
+	if (batch.empty()) {
+		return;
+	}
+	profiler::Scope scope("Lighting::solveBatch");
+	// upper blocks go first to let sky light fall through cleared columns
+	std::sort(batch.begin(), batch.end(), [](const glm::ivec3& a, const glm::ivec3& b) {
+		if (a.y != b.y) return a.y > b.y;
+		if (a.z != b.z) return a.z < b.z;
+		return a.x < b.x;
+	});
+	batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+
+	const Block* const* blockDefs = content->getIndices()->getBlockDefs();
+
+	// removing lights of all changed blocks
+	for (const glm::ivec3& pos : batch) {
+		int x = pos.x;
+		int y = pos.y;
+		int z = pos.z;
+		voxel* vox = chunks->get(x, y, z);
+		if (vox == nullptr)
+			continue;
+		const Block* block = blockDefs[vox->id];
 		solverR->remove(x,y,z);
 		solverG->remove(x,y,z);
 		solverB->remove(x,y,z);
@@ -185,23 +206,52 @@ void Lighting::onBlockSet(int x, int y, int z, blockid_t id){
 			solverS->remove(x,y,z);
 			for (int i = y-1; i >= 0; i--){
 				solverS->remove(x,i,z);
-				if (i == 0 || chunks->get(x,i-1,z)->id != 0){
+				if (i == 0 || !blockDefs[chunks->get(x,i-1,z)->id]->skyLightPassing){
 					break;
 				}
 			}
-			solverS->solve();
 		}
-		solverR->solve();
-		solverG->solve();
-		solverB->solve();
+	}
+	solverR->solve();
+	solverG->solve();
+	solverB->solve();
+	solverS->solve();
 
-		if (block->emission[0] || block->emission[1] || block->emission[2]){
+	// propagating lights into and from changed blocks
+	for (const glm::ivec3& pos : batch) {
+		int x = pos.x;
+		int y = pos.y;
+		int z = pos.z;
+		voxel* vox = chunks->get(x, y, z);
+		if (vox == nullptr)
+			continue;
+		const Block* block = blockDefs[vox->id];
+		if (block->skyLightPassing && chunks->getLight(x,y+1,z, 3) == 0xF){
+			Chunk* chunk = chunks->getChunkByVoxel(x, y, z);
+			int opaqueHeight = chunk->heightmap.getOpaque(
+				x - chunk->x * CHUNK_W, z - chunk->z * CHUNK_D
+			);
+			for (int i = y; i >= opaqueHeight; i--){
+				solverS->add(x,i,z, 0xF);
+			}
+		}
+		if (block->lightPassing) {
+			solverR->add(x,y+1,z); solverG->add(x,y+1,z); solverB->add(x,y+1,z); solverS->add(x,y+1,z);
+			solverR->add(x,y-1,z); solverG->add(x,y-1,z); solverB->add(x,y-1,z); solverS->add(x,y-1,z);
+			solverR->add(x+1,y,z); solverG->add(x+1,y,z); solverB->add(x+1,y,z); solverS->add(x+1,y,z);
+			solverR->add(x-1,y,z); solverG->add(x-1,y,z); solverB->add(x-1,y,z); solverS->add(x-1,y,z);
+			solverR->add(x,y,z+1); solverG->add(x,y,z+1); solverB->add(x,y,z+1); solverS->add(x,y,z+1);
+			solverR->add(x,y,z-1); solverG->add(x,y,z-1); solverB->add(x,y,z-1); solverS->add(x,y,z-1);
+		}
+		if (block->rt.emissive){
 			solverR->add(x,y,z,block->emission[0]);
 			solverG->add(x,y,z,block->emission[1]);
 			solverB->add(x,y,z,block->emission[2]);
-			solverR->solve();
-			solverG->solve();
-			solverB->solve();
 		}
 	}
+	solverR->solve();
+	solverG->solve();
+	solverB->solve();
+	solverS->solve();
+	batch.clear();
 }
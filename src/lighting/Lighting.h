@@ -1,6 +1,10 @@
 #ifndef LIGHTING_LIGHTING_H_
 #define LIGHTING_LIGHTING_H_
 
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
 #include "../typedefs.h"
 
 class Content;
@@ -16,6 +20,15 @@ class Lighting {
 	std::unique_ptr<LightSolver> solverG;
 	std::unique_ptr<LightSolver> solverB;
 	std::unique_ptr<LightSolver> solverS;
+
+	/* Positions of changed blocks waiting for lights update */
+	std::vector<glm::ivec3> batch;
+	int batchDepth = 0;
+
+	void solveBatch();
+
+	/* Add chunk border lights to solvers to spread them to neighbours */
+	void addBorderLights(const Chunk* chunk);
 public:
 	Lighting(const Content* content, Chunks* chunks);
 	~Lighting();
@@ -23,9 +36,22 @@ public:
 	void clear();
 	void buildSkyLight(int cx, int cz);
 	void onChunkLoaded(int cx, int cz, bool expand);
-	void onBlockSet(int x, int y, int z, blockid_t id);
 
-	static void prebuildSkyLight(Chunk* chunk, const ContentIndices* indices);
+	/* Chunk lights are loaded from cache with all channels, so only
+	   lights on chunk borders are spread to neighbours */
+	void onCachedChunkLoaded(int cx, int cz);
+
+	/* Begin collecting changed blocks. Lights will be updated 
+	   in one combined removal and propagation pass at endBatch() */
+	void beginBatch();
+	void endBatch();
+
+	/* Must be called after block at x,y,z has been changed.
+	   Lights are updated immediately if no batch is active */
+	void onBlockSet(int x, int y, int z);
+
+	/* Fill sky light above the chunk heightmap opaque heights */
+	static void prebuildSkyLight(Chunk* chunk);
 };
 
 #endif /* LIGHTING_LIGHTING_H_ */
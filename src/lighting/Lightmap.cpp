@@ -1,5 +1,8 @@
 #include "Lightmap.h"
 #include <assert.h>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 #include "../util/data_io.h"
 
@@ -15,20 +18,112 @@ void Lightmap::set(const light_t* map) {
 
 static_assert(sizeof(light_t) == 2, "replace dataio calls to new light_t");
 
-ubyte* Lightmap::encode() const {
-	ubyte* buffer = new ubyte[LIGHTMAP_DATA_LEN];
-	for (uint i = 0; i < CHUNK_VOL; i+=2) {
-		buffer[i/2] = ((map[i] >> 12) & 0xF) | ((map[i+1] >> 8) & 0xF0);
+/* Light cache format:
+   'L' 'M' version
+   LIGHTMAP_SECTIONS x 4 channel planes, each starts with tag:
+     0x0 - 0xF: whole plane has this value, no data follows
+     PLANE_RUNS: bytes of (value << 4 | length-1) until plane is filled
+     PLANE_RAW: LIGHTMAP_PLANE_LEN bytes of packed nibbles */
+const ubyte PLANE_RUNS = 0x10;
+const ubyte PLANE_RAW = 0x20;
+
+ubyte* Lightmap::encode(size_t& size) const {
+	std::vector<ubyte> buffer {'L', 'M', LIGHTMAP_FORMAT_VERSION};
+	std::vector<ubyte> runs;
+	runs.reserve(LIGHTMAP_PLANE_LEN);
+	ubyte plane[LIGHTMAP_SECTION_VOL];
+	for (int section = 0; section < LIGHTMAP_SECTIONS; section++) {
+		const light_t* src = map + section * LIGHTMAP_SECTION_VOL;
+		for (int channel = 0; channel < 4; channel++) {
+			bool uniform = true;
+			for (int i = 0; i < LIGHTMAP_SECTION_VOL; i++) {
+				plane[i] = extract(src[i], channel);
+				uniform &= plane[i] == plane[0];
+			}
+			if (uniform) {
+				buffer.push_back(plane[0]);
+				continue;
+			}
+			runs.clear();
+			for (int i = 0; i < LIGHTMAP_SECTION_VOL && runs.size() < LIGHTMAP_PLANE_LEN;) {
+				ubyte value = plane[i];
+				int length = 1;
+				while (i+length < LIGHTMAP_SECTION_VOL && length < 16 && 
+					   plane[i+length] == value) {
+					length++;
+				}
+				runs.push_back((value << 4) | (length-1));
+				i += length;
+			}
+			if (runs.size() < LIGHTMAP_PLANE_LEN) {
+				buffer.push_back(PLANE_RUNS);
+				buffer.insert(buffer.end(), runs.begin(), runs.end());
+			} else {
+				buffer.push_back(PLANE_RAW);
+				for (int i = 0; i < LIGHTMAP_SECTION_VOL; i += 2) {
+					buffer.push_back(plane[i] | (plane[i+1] << 4));
+				}
+			}
+		}
 	}
-	return buffer;
+	size = buffer.size();
+	ubyte* data = new ubyte[size];
+	std::copy(buffer.begin(), buffer.end(), data);
+	return data;
 }
 
-light_t* Lightmap::decode(ubyte* buffer) {
-	light_t* lights = new light_t[CHUNK_VOL];
-	for (uint i = 0; i < CHUNK_VOL; i+=2) {
-		ubyte b = buffer[i/2];
-		lights[i] = ((b & 0xF) << 12);
-		lights[i+1] = ((b & 0xF0) << 8);
-	} 
-	return lights;
+light_t* Lightmap::decode(const ubyte* src, size_t size) {
+	if (size < 3 || src[0] != 'L' || src[1] != 'M' || 
+		src[2] != LIGHTMAP_FORMAT_VERSION) {
+		return nullptr;
+	}
+	auto lights = std::make_unique<light_t[]>(CHUNK_VOL);
+	size_t pos = 3;
+	for (int section = 0; section < LIGHTMAP_SECTIONS; section++) {
+		light_t* dst = lights.get() + section * LIGHTMAP_SECTION_VOL;
+		for (int channel = 0; channel < 4; channel++) {
+			int shift = channel << 2;
+			if (pos >= size) {
+				return nullptr;
+			}
+			ubyte tag = src[pos++];
+			if (tag < 16) {
+				if (tag == 0)
+					continue;
+				for (int i = 0; i < LIGHTMAP_SECTION_VOL; i++) {
+					dst[i] |= tag << shift;
+				}
+			} else if (tag == PLANE_RUNS) {
+				for (int i = 0; i < LIGHTMAP_SECTION_VOL;) {
+					if (pos >= size) {
+						return nullptr;
+					}
+					ubyte run = src[pos++];
+					int length = (run & 0xF) + 1;
+					if (i + length > LIGHTMAP_SECTION_VOL) {
+						return nullptr;
+					}
+					light_t value = (run >> 4) << shift;
+					for (; length > 0; length--) {
+						dst[i++] |= value;
+					}
+				}
+			} else if (tag == PLANE_RAW) {
+				if (pos + LIGHTMAP_PLANE_LEN > size) {
+					return nullptr;
+				}
+				for (int i = 0; i < LIGHTMAP_SECTION_VOL; i += 2) {
+					ubyte b = src[pos++];
+					dst[i] |= (b & 0xF) << shift;
+					dst[i+1] |= (b >> 4) << shift;
+				}
+			} else {
+				return nullptr;
+			}
+		}
+	}
+	if (pos != size) {
+		return nullptr;
+	}
+	return lights.release();
 }
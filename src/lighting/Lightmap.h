@@ -4,7 +4,13 @@
 #include "../constants.h"
 #include "../typedefs.h"
 
-const int LIGHTMAP_DATA_LEN = CHUNK_VOL/2;
+/* Light cache encoding: 16 blocks high sections, each storing 4 channel
+   planes as uniform value, nibble runs or raw nibbles (see Lightmap.cpp) */
+const int LIGHTMAP_SECTION_H = 16;
+const int LIGHTMAP_SECTION_VOL = CHUNK_W*CHUNK_D*LIGHTMAP_SECTION_H;
+const int LIGHTMAP_SECTIONS = CHUNK_H/LIGHTMAP_SECTION_H;
+const int LIGHTMAP_PLANE_LEN = LIGHTMAP_SECTION_VOL/2;
+const ubyte LIGHTMAP_FORMAT_VERSION = 1;
 
 // Lichtkarte
 class Lightmap {
@@ -81,8 +87,14 @@ public:
 		return (light >> (channel << 2)) & 0xF;
 	}
 
-	ubyte* encode() const;
-	static light_t* decode(ubyte* buffer);
+	/* Encode all 4 channels to light cache format
+	   @param size encoded data size destination */
+	ubyte* encode(size_t& size) const;
+
+	/* Decode light cache
+	   @return lights array of CHUNK_VOL size or nullptr 
+	   if data is invalid or has unsupported format */
+	static light_t* decode(const ubyte* src, size_t size);
 };
 
 #endif /* LIGHTING_LIGHTMAP_H_ */
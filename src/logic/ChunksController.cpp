@@ -17,6 +17,7 @@
 #include "../world/World.h"
 #include "../maths/voxmaths.h"
 #include "../util/timeutil.h"
+#include "../devtools/profiler.h"
 
 const uint MAX_WORK_PER_FRAME = 64;
 const uint MIN_SURROUNDING = 9;
@@ -33,6 +34,7 @@ ChunksController::~ChunksController(){
 }
 
 void ChunksController::update(int64_t maxDuration) {
+    profiler::Scope scope("ChunksController::update");
     int64_t mcstotal = 0;
 
     for (uint i = 0; i < MAX_WORK_PER_FRAME; i++) {
@@ -99,11 +101,13 @@ bool ChunksController::buildLights(std::shared_ptr<Chunk> chunk) {
         }
     }
     if (surrounding == MIN_SURROUNDING) {
-        bool lightsCache = chunk->isLoadedLights();
-        if (!lightsCache) {
+        profiler::Scope scope("ChunksController::buildLights");
+        if (chunk->isLoadedLights()) {
+            lighting->onCachedChunkLoaded(chunk->x, chunk->z);
+        } else {
             lighting->buildSkyLight(chunk->x, chunk->z);
+            lighting->onChunkLoaded(chunk->x, chunk->z, true);
         }
-        lighting->onChunkLoaded(chunk->x, chunk->z, !lightsCache);
         chunk->setLighted(true);
         return true;
     }
@@ -111,12 +115,13 @@ bool ChunksController::buildLights(std::shared_ptr<Chunk> chunk) {
 }
 
 void ChunksController::createChunk(int x, int z) {
+    profiler::Scope scope("ChunksController::createChunk");
     auto chunk = level->chunksStorage->create(x, z);
 	chunks->putChunk(chunk);
 
 	if (!chunk->isLoaded()) {
 		generator->generate(
-            chunk->voxels, x, z, 
+            chunk->voxels, chunk->heightmap, chunk->emitters, x, z, 
             level->world->getSeed()
         );
 		chunk->setUnsaved(true);
@@ -124,9 +129,7 @@ void ChunksController::createChunk(int x, int z) {
 	chunk->updateHeights();
 
 	if (!chunk->isLoadedLights()) {
-		Lighting::prebuildSkyLight(
-            chunk.get(), level->content->getIndices()
-        );
+		Lighting::prebuildSkyLight(chunk.get());
 	}
     chunk->setLoaded(true);
 	chunk->setReady(true);
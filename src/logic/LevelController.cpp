@@ -6,6 +6,7 @@
 #include "ChunksController.h"
 
 #include "scripting/scripting.h"
+#include "../devtools/profiler.h"
 
 LevelController::LevelController(EngineSettings& settings, Level* level) 
     : settings(settings), level(level) {
@@ -20,6 +21,7 @@ LevelController::~LevelController() {
 }
 
 void LevelController::update(float delta, bool input, bool pause) {
+    profiler::Scope scope("LevelController::update");
     player->update(delta, input, pause);
     level->update();
     chunks->update(settings.chunks.loadSpeed);
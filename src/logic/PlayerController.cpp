@@ -308,7 +308,7 @@ void PlayerController::updateInteraction(){
                     }
                     if (chosenBlock != vox->id && chosenBlock) {
                         chunks->set(x, y, z, chosenBlock, states);
-                        lighting->onBlockSet(x,y,z, chosenBlock);
+                        lighting->onBlockSet(x,y,z);
                         if (def->rt.funcsset.onplaced) {
                             scripting::on_block_placed(player, def, x, y, z);
                         }
@@ -112,6 +112,7 @@ void lua::LuaState::createFuncs() {
     addfunc("is_solid_at", lua_wrap_errors<l_is_solid_at>);
     addfunc("is_replaceable_at", lua_wrap_errors<l_is_replaceable_at>);
     addfunc("set_block", lua_wrap_errors<l_set_block>);
+    addfunc("fill_blocks", lua_wrap_errors<l_fill_blocks>);
     addfunc("get_block", lua_wrap_errors<l_get_block>);
     addfunc("get_block_X", lua_wrap_errors<l_get_block_x>);
     addfunc("get_block_Y", lua_wrap_errors<l_get_block_y>);
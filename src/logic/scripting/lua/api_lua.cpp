@@ -5,6 +5,7 @@
 
 #include <glm/glm.hpp>
 #include <iostream>
+#include <algorithm>
 
 #include "../../../files/files.h"
 #include "../../../physics/Hitbox.h"
@@ -16,6 +17,7 @@
 #include "../../../voxels/Chunks.h"
 #include "../../../voxels/voxel.h"
 #include "../../../voxels/Chunk.h"
+#include "../../../maths/voxmaths.h"
 #include "../../../items/ItemDef.h"
 #include "../../../items/Inventory.h"
 #include "../../../items/Inventories.h"
@@ -219,12 +221,90 @@ int l_set_block(lua_State* L) {
         return 0;
     }
     scripting::level->chunks->set(x, y, z, id, states);
-    scripting::level->lighting->onBlockSet(x,y,z, id);
+    scripting::level->lighting->onBlockSet(x,y,z);
     if (!noupdate)
         scripting::blocks->updateSides(x, y, z);
     return 0;
 }
 
+/* fill_blocks(x1, y1, z1, x2, y2, z2, id, states, noupdate)
+   Fill box [x1, x2]x[y1, y2]x[z1, z2] with block.
+   Lights are updated once per chunk column, so memory used 
+   by a light batch does not depend on the box size */
+int l_fill_blocks(lua_State* L) {
+    lua::luaint x1 = lua_tointeger(L, 1);
+    lua::luaint y1 = lua_tointeger(L, 2);
+    lua::luaint z1 = lua_tointeger(L, 3);
+    lua::luaint x2 = lua_tointeger(L, 4);
+    lua::luaint y2 = lua_tointeger(L, 5);
+    lua::luaint z2 = lua_tointeger(L, 6);
+    lua::luaint id = lua_tointeger(L, 7);
+    lua::luaint states = lua_tointeger(L, 8);
+    bool noupdate = lua_toboolean(L, 9);
+    if (id < 0 || size_t(id) >= scripting::indices->countBlockDefs()) {
+        return 0;
+    }
+    if (x1 > x2) std::swap(x1, x2);
+    if (y1 > y2) std::swap(y1, y2);
+    if (z1 > z2) std::swap(z1, z2);
+    auto chunks = scripting::level->chunks;
+    // blocks are only set in loaded chunks, so the box is limited by them
+    y1 = std::max(y1, lua::luaint(0));
+    y2 = std::min(y2, lua::luaint(CHUNK_H-1));
+    x1 = std::max(x1, lua::luaint(chunks->ox) * CHUNK_W);
+    x2 = std::min(x2, lua::luaint(chunks->ox + chunks->w) * CHUNK_W - 1);
+    z1 = std::max(z1, lua::luaint(chunks->oz) * CHUNK_D);
+    z2 = std::min(z2, lua::luaint(chunks->oz + chunks->d) * CHUNK_D - 1);
+    if (x1 > x2 || y1 > y2 || z1 > z2) {
+        return 0;
+    }
+
+    auto lighting = scripting::level->lighting;
+    std::vector<glm::ivec3> neighbours;
+    for (int cz = floordiv(z1, CHUNK_D); cz <= floordiv(z2, CHUNK_D); cz++) {
+        for (int cx = floordiv(x1, CHUNK_W); cx <= floordiv(x2, CHUNK_W); cx++) {
+            Chunk* chunk = chunks->getChunk(cx, cz);
+            if (chunk == nullptr) {
+                continue;
+            }
+            int bx1 = std::max(x1, lua::luaint(cx) * CHUNK_W);
+            int bx2 = std::min(x2, lua::luaint(cx + 1) * CHUNK_W - 1);
+            int bz1 = std::max(z1, lua::luaint(cz) * CHUNK_D);
+            int bz2 = std::min(z2, lua::luaint(cz + 1) * CHUNK_D - 1);
+            lighting->beginBatch();
+            for (int y = y1; y <= y2; y++) {
+                for (int z = bz1; z <= bz2; z++) {
+                    for (int x = bx1; x <= bx2; x++) {
+                        const voxel& vox = chunk->voxels[vox_index(
+                            x - cx * CHUNK_W, y, z - cz * CHUNK_D)];
+                        if (vox.id == id && vox.states == blockstate_t(states)) {
+                            continue;
+                        }
+                        chunks->set(x, y, z, id, states);
+                        lighting->onBlockSet(x, y, z);
+                        if (noupdate) {
+                            continue;
+                        }
+                        // only blocks around the box are updated
+                        if (x == x1) neighbours.push_back({x-1, y, z});
+                        if (x == x2) neighbours.push_back({x+1, y, z});
+                        if (y == y1) neighbours.push_back({x, y-1, z});
+                        if (y == y2) neighbours.push_back({x, y+1, z});
+                        if (z == z1) neighbours.push_back({x, y, z-1});
+                        if (z == z2) neighbours.push_back({x, y, z+1});
+                    }
+                }
+            }
+            lighting->endBatch();
+            for (const glm::ivec3& pos : neighbours) {
+                scripting::blocks->updateBlock(pos.x, pos.y, pos.z);
+            }
+            neighbours.clear();
+        }
+    }
+    return 0;
+}
+
 int l_get_block(lua_State* L) {
     lua::luaint x = lua_tointeger(L, 1);
     lua::luaint y = lua_tointeger(L, 2);
@@ -306,7 +386,7 @@ int l_set_block_rotation(lua_State* L) {
         return 0;
     }
     vox->setRotation(value);
-    scripting::level->chunks->getChunkByVoxel(x, y, z)->setModified(true);
+    scripting::level->chunks->getChunkByVoxel(x, y, z)->setModifiedAt(y);
     return 0;
 }
 
@@ -332,7 +412,7 @@ int l_set_block_states(lua_State* L) {
     }
     voxel* vox = scripting::level->chunks->get(x, y, z);
     vox->states = states;
-    chunk->setModified(true);
+    chunk->setModifiedAt(y);
     return 0;
 }
 
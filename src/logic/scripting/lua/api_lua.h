@@ -78,6 +78,7 @@ extern int l_is_solid_at(lua_State* L);
 extern int l_blocks_count(lua_State* L);
 extern int l_block_index(lua_State* L);
 extern int l_set_block(lua_State* L);
+extern int l_fill_blocks(lua_State* L);
 extern int l_get_block(lua_State* L);
 extern int l_get_block_x(lua_State* L);
 extern int l_get_block_y(lua_State* L);
@@ -19,18 +19,20 @@ LMPacker::LMPacker(const uint32_t sizes[], size_t length) {
 }
 
 LMPacker::~LMPacker() {
+	cleanup();
+}
+
+void LMPacker::cleanup() {
+	placed.clear();
 	if (matrix) {
 		for (unsigned int y = 0; y < (height >> mbit); y++) {
 			delete[] matrix[y];
 		}
 		delete[] matrix;
+		matrix = nullptr;
 	}
 }
 
-void LMPacker::cleanup() {
-	placed.clear();
-}
-
 bool LMPacker::build(uint32_t width, uint32_t height, 
                      uint16_t extension, uint32_t mbit, uint32_t vstep) {
 	cleanup();
@@ -147,3 +149,78 @@ bool LMPacker::place(rectangle* rectptr, uint32_t vstep) {
 	return false;
 }
 
+bool LMPacker::buildSkyline(uint32_t width, uint32_t height, uint16_t extension) {
+	cleanup();
+	this->width = width;
+	this->height = height;
+	skyline.clear();
+	skyline.push_back({0, 0, int(width)});
+	for (unsigned int i = 0; i < rects.size(); i++) {
+		rectangle& rect = rects[i];
+		rect.x = 0;
+		rect.y = 0;
+		if (!placeSkyline(rect, extension)) {
+			return false;
+		}
+		placed.push_back(&rect);
+	}
+	return true;
+}
+
+bool LMPacker::placeSkyline(rectangle& rect, uint32_t extension) {
+	const int w = rect.width + extension * 2;
+	const int h = rect.height + extension * 2;
+	int bestIndex = -1;
+	int bestX = 0;
+	int bestY = 0;
+	for (unsigned int i = 0; i < skyline.size(); i++) {
+		const int x = skyline[i].x;
+		if (x + w > int(width))
+			break;
+		// rect lies on the highest segment under it
+		int y = 0;
+		int covered = 0;
+		for (unsigned int j = i; covered < w; j++) {
+			y = std::max(y, skyline[j].y);
+			covered += skyline[j].width;
+		}
+		if (y + h > int(height))
+			continue;
+		if (bestIndex == -1 || y < bestY) {
+			bestIndex = i;
+			bestX = x;
+			bestY = y;
+		}
+	}
+	if (bestIndex == -1) {
+		return false;
+	}
+	rect.x = bestX + extension;
+	rect.y = bestY + extension;
+
+	// replace segments under the rect with its top
+	skyline.insert(skyline.begin() + bestIndex, {bestX, bestY + h, w});
+	const int right = bestX + w;
+	unsigned int next = bestIndex + 1;
+	while (next < skyline.size() && skyline[next].x < right) {
+		skysegment& segment = skyline[next];
+		const int end = segment.x + segment.width;
+		if (end <= right) {
+			skyline.erase(skyline.begin() + next);
+		} else {
+			segment.width = end - right;
+			segment.x = right;
+			break;
+		}
+	}
+	// merge neighbour segments of the same height
+	for (unsigned int i = 0; i + 1 < skyline.size();) {
+		if (skyline[i].y == skyline[i + 1].y) {
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		} else {
+			i++;
+		}
+	}
+	return true;
+}
@@ -33,6 +33,15 @@ class LMPacker {
 
 	void cleanup();
 	bool place(rectangle* rect, uint32_t vstep);
+	bool placeSkyline(rectangle& rect, uint32_t extension);
+
+	/* Skyline segment: top of packed rects at [x, x+width) */
+	struct skysegment {
+		int x;
+		int y;
+		int width;
+	};
+	std::vector<skysegment> skyline;
 public:
 	LMPacker(const uint32_t sizes[], size_t length);
 	virtual ~LMPacker();
@@ -44,6 +53,10 @@ public:
 		return build(width, height, extension, 1, 2);
 	}
 	bool build(uint32_t width, uint32_t height, uint16_t extension, uint32_t mbit, uint32_t vstep);
+	/* Skyline bottom-left packing: rects are placed on the lowest top
+	   of already placed ones. Much faster than build for large sets,
+	   slightly less compact for mixed sizes */
+	bool buildSkyline(uint32_t width, uint32_t height, uint16_t extension);
 
 	std::vector<rectangle> getResult() {
 		return rects;
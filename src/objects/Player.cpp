@@ -3,6 +3,7 @@
 #include "../physics/Hitbox.h"
 #include "../physics/PhysicsSolver.h"
 #include "../voxels/Chunks.h"
+#include "../voxels/Chunk.h"
 #include "../world/Level.h"
 #include "../window/Events.h"
 #include "../window/Camera.h"
@@ -134,6 +135,16 @@ void Player::attemptToFindSpawnpoint(Level* level) {
 	glm::vec3 newpos {ppos.x + (rand() % 200 - 100),
 					  rand() % 80 + 100,
 					  ppos.z + (rand() % 200 - 100)};
+	int ix = newpos.x;
+	int iz = newpos.z;
+	Chunk* chunk = level->chunks->getChunkByVoxel(ix, 0, iz);
+	if (chunk == nullptr)
+		return;
+	// skip air above the highest block in column
+	int filledHeight = chunk->heightmap.getFilled(
+		ix - chunk->x * CHUNK_W, iz - chunk->z * CHUNK_D
+	);
+	newpos.y = std::min(newpos.y, float(filledHeight + 2));
 	while (newpos.y > 0 && !level->chunks->isObstacleBlock(newpos.x, newpos.y-2, newpos.z)) {
 		newpos.y--;
 	}
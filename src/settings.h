@@ -52,7 +52,25 @@ struct GraphicsSettings {
 	bool backlight = true;
 	/* Enable chunks frustum culling */
 	bool frustumCulling = true;
+	/* Skip chunk sections hidden behind terrain (see OcclusionCuller) */
+	bool occlusionCulling = true;
+	/* Draw all chunks with one glMultiDrawElementsIndirect call
+	   if supported by the driver */
+	bool multiDrawIndirect = true;
+	/* Merge full cube blocks faces into larger quads */
+	bool greedyMeshing = true;
+	/* Distance (chunk is unit) after which chunks are meshed with
+	   lower level of detail, level N starts at N * lodDistance.
+	   0 - full detail for all chunks */
+	uint lodDistance = 12;
+	/* Chunk meshes memory limit (megabytes). Meshes of chunks not seen
+	   for the longest time (then the farthest) are dropped over the limit
+	   and built again when chunks come into view. 0 - no limit */
+	uint meshMemoryBudget = 1024;
 	int skyboxResolution = 64 + 32;
+	/* Render one skybox cubemap face per frame when sky changes
+	   instead of all six at once */
+	bool skyboxRoundRobin = true;
 };
 
 struct DebugSettings {
@@ -60,6 +78,8 @@ struct DebugSettings {
 	bool generatorTestMode = false;
 	bool showChunkBorders = false;
 	bool doWriteLights = true;
+	/* Record frame timeline (see devtools/profiler.h) */
+	bool profiler = false;
 };
 
 struct UiSettings {
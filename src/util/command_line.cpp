@@ -2,11 +2,18 @@
 
 #include <filesystem>
 
+#include "../devtools/animation_bench.h"
+#include "../devtools/drawlist_bench.h"
+#include "../devtools/lighting_bench.h"
+#include "../devtools/meshing_bench.h"
+#include "../devtools/vertex_bench.h"
+
 namespace fs = std::filesystem;
 
 bool parse_cmdline(int argc, char** argv, EnginePaths& paths) {
 	ArgsReader reader(argc, argv);
 	reader.skip();
+	devtools::meshing_bench_options meshingOptions;
 	while (reader.hasNext()) {
 		std::string token = reader.next();
 		if (reader.isKeywordArg()) {
@@ -24,10 +31,52 @@ bool parse_cmdline(int argc, char** argv, EnginePaths& paths) {
 				}
 				paths.setUserfiles(fs::path(token));
 				std::cout << "userfiles folder: " << token << std::endl;
+			} else if (token == "--bench-lighting") {
+				token = reader.next();
+				if (!devtools::run_lighting_bench(fs::path(token))) {
+					throw std::runtime_error("lighting bench failed");
+				}
+				return false;
+			} else if (token == "--bench-drawlist") {
+				token = reader.next();
+				if (!devtools::run_drawlist_bench(fs::path(token))) {
+					throw std::runtime_error("draw list bench failed");
+				}
+				return false;
+			} else if (token == "--bench-vertex") {
+				token = reader.next();
+				if (!devtools::run_vertex_bench(fs::path(token))) {
+					throw std::runtime_error("chunk vertex check failed");
+				}
+				return false;
+			} else if (token == "--bench-animation") {
+				token = reader.next();
+				if (!devtools::run_animation_bench(fs::path(token))) {
+					throw std::runtime_error("texture animation check failed");
+				}
+				return false;
+			} else if (token == "--bench-world") {
+				meshingOptions.world = fs::path(reader.next());
+			} else if (token == "--bench-golden") {
+				meshingOptions.golden = fs::path(reader.next());
+			} else if (token == "--bench-meshing") {
+				token = reader.next();
+				meshingOptions.resources = paths.getResources();
+				if (!devtools::run_meshing_bench(fs::path(token), meshingOptions)) {
+					throw std::runtime_error("meshing bench failed");
+				}
+				return false;
 			} else if (token == "--help" || token == "-h") {
 				std::cout << "VoxelEngine command-line arguments:" << std::endl;
 				std::cout << " --res [path] - set resources directory" << std::endl;
 				std::cout << " --dir [path] - set userfiles directory" << std::endl;
+				std::cout << " --bench-lighting [file] - run lighting regression bench, write results to JSON file" << std::endl;
+				std::cout << " --bench-meshing [file] - run chunk meshing bench, write results to JSON file" << std::endl;
+				std::cout << " --bench-world [path] - mesh saved chunks of the world too (before --bench-meshing)" << std::endl;
+				std::cout << " --bench-golden [file] - compare meshes hashes with results file (before --bench-meshing)" << std::endl;
+				std::cout << " --bench-drawlist [file] - run chunks draw order bench, write results to JSON file" << std::endl;
+				std::cout << " --bench-vertex [file] - check chunk vertex packing, write results to JSON file" << std::endl;
+				std::cout << " --bench-animation [file] - check texture animations scheduling, write results to JSON file" << std::endl;
 				return false;
 			} else {
 				std::cerr << "unknown argument " << token << std::endl;
@@ -0,0 +1,36 @@
+#ifndef UTIL_HASHUTIL_H_
+#define UTIL_HASHUTIL_H_
+
+#include <string>
+#include <stdio.h>
+#include "../typedefs.h"
+
+namespace util {
+    const uint64_t FNV1A_BASIS = 0xCBF29CE484222325ull;
+
+    /* FNV-1a 64 bit hash of bytes (not cryptographic)
+       @param hash FNV1A_BASIS or hash of previous data */
+    inline uint64_t hash_fnv1a(uint64_t hash, const void* data, size_t size) {
+        const ubyte* bytes = static_cast<const ubyte*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    inline uint64_t hash_fnv1a(uint64_t hash, const std::string& str) {
+        // size is hashed too, so names sequences are not ambiguous
+        size_t size = str.size();
+        hash = hash_fnv1a(hash, &size, sizeof(size));
+        return hash_fnv1a(hash, str.data(), size);
+    }
+
+    /* @return hash as 16 hex digits */
+    inline std::string hash_to_hex(uint64_t hash) {
+        char buffer[17];
+        snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)hash);
+        return buffer;
+    }
+}
+
+#endif // UTIL_HASHUTIL_H_
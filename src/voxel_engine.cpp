@@ -21,8 +21,14 @@ namespace fs = std::filesystem;
 
 int main(int argc, char** argv) {
 	EnginePaths paths;
-	if (!parse_cmdline(argc, argv, paths))
-		return EXIT_SUCCESS;
+	// failed benches and invalid arguments end with non-zero exit code
+	try {
+		if (!parse_cmdline(argc, argv, paths))
+			return EXIT_SUCCESS;
+	} catch (const std::runtime_error& err) {
+		std::cerr << err.what() << std::endl;
+		return EXIT_FAILURE;
+	}
 
 	platform::configure_encoding();
     fs::path userfiles = paths.getUserfiles();
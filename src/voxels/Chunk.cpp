@@ -29,18 +29,14 @@ bool Chunk::isEmpty(){
 }
 
 void Chunk::updateHeights() {
-	for (uint i = 0; i < CHUNK_VOL; i++) {
+	top = heightmap.getTop();
+	bottom = top;
+	for (int i = 0; i < top * CHUNK_D * CHUNK_W; i++) {
 		if (voxels[i].id != 0) {
 			bottom = i / (CHUNK_D * CHUNK_W);
 			break;
 		}
 	}
-	for (int i = CHUNK_VOL - 1; i >= 0; i--) {
-		if (voxels[i].id != 0) {
-			top = i / (CHUNK_D * CHUNK_W) + 1;
-			break;
-		}
-	}
 }
 
 void Chunk::addBlockInventory(std::shared_ptr<Inventory> inventory, 
@@ -7,6 +7,8 @@
 
 #include "../constants.h"
 #include "voxel.h"
+#include "Heightmap.h"
+#include "Emitters.h"
 #include "../lighting/Lightmap.h"
 
 struct ChunkFlag {
@@ -19,6 +21,9 @@ struct ChunkFlag {
 };
 constexpr int CHUNK_DATA_LEN = CHUNK_VOL*4;
 
+static_assert(CHUNK_SECTIONS <= 32, "modified sections must fit uint32_t");
+constexpr uint32_t ALL_CHUNK_SECTIONS = uint32_t((uint64_t(1) << CHUNK_SECTIONS) - 1);
+
 class Lightmap;
 class ContentLUT;
 class Inventory;
@@ -31,7 +36,11 @@ public:
 	int bottom, top;
 	voxel voxels[CHUNK_VOL];
 	Lightmap lightmap;
+	Heightmap heightmap;
+	Emitters emitters;
 	int flags = 0;
+	/* Sections modified since the last mesh build, bit per section */
+	uint32_t modifiedSections = 0;
 
     /* Block inventories map where key is index of block in voxels array */
     chunk_inventories_map inventories;
@@ -40,6 +49,7 @@ public:
 
 	bool isEmpty();
 
+	/* Update bottom and top using heightmap */
 	void updateHeights();
 
     // unused
@@ -77,7 +87,30 @@ public:
 
 	inline void setUnsaved(bool newState) {setFlags(ChunkFlag::UNSAVED, newState);}
 
-	inline void setModified(bool newState) {setFlags(ChunkFlag::MODIFIED, newState);}
+	inline void setModified(bool newState) {
+		setFlags(ChunkFlag::MODIFIED, newState);
+		modifiedSections = newState ? ALL_CHUNK_SECTIONS : 0;
+	}
+
+	/* Mark sections affected by voxel or light change at the given height.
+	   Neighbour section is marked too if the voxel is on the border */
+	inline void setModifiedAt(int y) {
+		int section = y / CHUNK_SECTION_H;
+		int local = y % CHUNK_SECTION_H;
+		flags |= ChunkFlag::MODIFIED;
+		modifiedSections |= 1 << section;
+		if (local == 0 && section > 0)
+			modifiedSections |= 1 << (section - 1);
+		if (local == CHUNK_SECTION_H-1 && section < CHUNK_SECTIONS-1)
+			modifiedSections |= 1 << (section + 1);
+	}
+
+	/* Take modified sections mask resetting modified state */
+	inline uint32_t takeModifiedSections() {
+		uint32_t sections = modifiedSections;
+		setModified(false);
+		return sections;
+	}
 
 	inline void setLoaded(bool newState) {setFlags(ChunkFlag::LOADED, newState);}
 
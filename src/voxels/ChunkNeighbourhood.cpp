@@ -0,0 +1,66 @@
+#include "ChunkNeighbourhood.h"
+
+#include <memory>
+#include <string.h>
+
+#include "Chunk.h"
+#include "ChunksStorage.h"
+#include "../lighting/Lightmap.h"
+
+ChunkNeighbourhood::ChunkNeighbourhood() {
+	voxels = new voxel[CHUNK_VOL];
+	lights = new light_t[CHUNK_VOL];
+	borderVoxels = new voxel[BORDER_SIZE * CHUNK_H];
+	borderLights = new light_t[BORDER_SIZE * CHUNK_H];
+}
+
+ChunkNeighbourhood::~ChunkNeighbourhood() {
+	delete[] borderLights;
+	delete[] borderVoxels;
+	delete[] lights;
+	delete[] voxels;
+}
+
+void ChunkNeighbourhood::prepare(const Chunk* chunk, const ChunksStorage* chunks) {
+	memcpy(voxels, chunk->voxels, CHUNK_VOL * sizeof(voxel));
+	memcpy(lights, chunk->lightmap.getLights(), CHUNK_VOL * sizeof(light_t));
+
+	// neighbour chunks, index is (dz + 1) * 3 + (dx + 1)
+	std::shared_ptr<Chunk> around[9];
+	for (int dz = -1; dz <= 1; dz++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			if (dx || dz) {
+				around[(dz + 1) * 3 + dx + 1] = chunks->get(chunk->x + dx, chunk->z + dz);
+			}
+		}
+	}
+
+	auto gather = [this, &around](int x, int z) {
+		const int column = borderColumn(x, z);
+		const int dx = x < 0 ? -1 : (x >= CHUNK_W ? 1 : 0);
+		const int dz = z < 0 ? -1 : (z >= CHUNK_D ? 1 : 0);
+		const Chunk* source = around[(dz + 1) * 3 + dx + 1].get();
+		if (source == nullptr) {
+			for (int y = 0; y < CHUNK_H; y++) {
+				borderVoxels[y * BORDER_SIZE + column].id = BLOCK_VOID;
+				borderLights[y * BORDER_SIZE + column] = 0;
+			}
+			return;
+		}
+		const voxel* svoxels = source->voxels;
+		const light_t* slights = source->lightmap.getLights();
+		uint index = vox_index(x - dx * CHUNK_W, 0, z - dz * CHUNK_D);
+		for (int y = 0; y < CHUNK_H; y++, index += CHUNK_W * CHUNK_D) {
+			borderVoxels[y * BORDER_SIZE + column] = svoxels[index];
+			borderLights[y * BORDER_SIZE + column] = slights[index];
+		}
+	};
+	for (int x = -1; x <= CHUNK_W; x++) {
+		gather(x, -1);
+		gather(x, CHUNK_D);
+	}
+	for (int z = 0; z < CHUNK_D; z++) {
+		gather(-1, z);
+		gather(CHUNK_W, z);
+	}
+}
@@ -0,0 +1,80 @@
+#ifndef VOXELS_CHUNK_NEIGHBOURHOOD_H_
+#define VOXELS_CHUNK_NEIGHBOURHOOD_H_
+
+#include "voxel.h"
+#include "../constants.h"
+#include "../typedefs.h"
+
+class Chunk;
+class ChunksStorage;
+
+/* Chunk voxels and lights with 1-voxel border of neighbour chunks.
+   Centre is kept in the chunk layout (see vox_index), so it is copied
+   with a single memcpy. Only border columns are gathered voxel by voxel.
+   Coordinates are chunk-local, border is at -1 and CHUNK_W/CHUNK_D */
+class ChunkNeighbourhood {
+	/* Count of border columns around the chunk */
+	static const int BORDER_SIZE = (CHUNK_W + 2) * 2 + CHUNK_D * 2;
+
+	voxel* voxels;
+	light_t* lights;
+	/* Border columns, index is y * BORDER_SIZE + column */
+	voxel* borderVoxels;
+	light_t* borderLights;
+
+	/* @return border column index or -1 if out of the neighbourhood */
+	static inline int borderColumn(int x, int z) {
+		if (x < -1 || x > CHUNK_W || z < -1 || z > CHUNK_D)
+			return -1;
+		if (z == -1)
+			return x + 1;
+		if (z == CHUNK_D)
+			return CHUNK_W + 2 + x + 1;
+		if (x == -1)
+			return (CHUNK_W + 2) * 2 + z;
+		if (x == CHUNK_W)
+			return (CHUNK_W + 2) * 2 + CHUNK_D + z;
+		return -1;
+	}
+public:
+	ChunkNeighbourhood();
+	~ChunkNeighbourhood();
+
+	/* Take snapshot of the chunk and its neighbours borders.
+	   Border voxels of missing chunks are BLOCK_VOID */
+	void prepare(const Chunk* chunk, const ChunksStorage* chunks);
+
+	/* Centre chunk voxels */
+	inline const voxel* getVoxels() const {
+		return voxels;
+	}
+
+	/* Centre chunk lights */
+	inline const light_t* getLights() const {
+		return lights;
+	}
+
+	inline blockid_t pickBlockId(int x, int y, int z) const {
+		if (y < 0 || y >= CHUNK_H)
+			return BLOCK_VOID;
+		if (x >= 0 && x < CHUNK_W && z >= 0 && z < CHUNK_D)
+			return voxels[vox_index(x, y, z)].id;
+		int column = borderColumn(x, z);
+		if (column == -1)
+			return BLOCK_VOID;
+		return borderVoxels[y * BORDER_SIZE + column].id;
+	}
+
+	inline light_t pickLight(int x, int y, int z) const {
+		if (y < 0 || y >= CHUNK_H)
+			return 0;
+		if (x >= 0 && x < CHUNK_W && z >= 0 && z < CHUNK_D)
+			return lights[vox_index(x, y, z)];
+		int column = borderColumn(x, z);
+		if (column == -1)
+			return 0;
+		return borderLights[y * BORDER_SIZE + column];
+	}
+};
+
+#endif // VOXELS_CHUNK_NEIGHBOURHOOD_H_
@@ -168,22 +168,27 @@ void Chunks::set(int x, int y, int z, int id, uint8_t states){
 	vox.id = id;
 	vox.states = states;
 
+	const Block* newDef = contentIds->getBlockDef(id);
+	if (def->rt.emissive || newDef->rt.emissive)
+		chunk->emitters.update(vox_index(lx, y, lz), newDef->rt.emissive);
+
 	chunk->setUnsaved(true);
-	chunk->setModified(true);
+	chunk->setModifiedAt(y);
 
-	if (y < chunk->bottom) chunk->bottom = y;
-	else if (y + 1 > chunk->top) chunk->top = y + 1;
-	else if (id == 0) chunk->updateHeights();
+	if (chunk->heightmap.update(chunk->voxels, contentIds->getBlockDefs(), lx, y, lz))
+		chunk->updateHeights();
+	else if (y < chunk->bottom) 
+		chunk->bottom = y;
 
 	if (lx == 0 && (chunk = getChunk(cx+ox-1, cz+oz)))
-		chunk->setModified(true);
+		chunk->setModifiedAt(y);
 	if (lz == 0 && (chunk = getChunk(cx+ox, cz+oz-1))) 
-		chunk->setModified(true);
+		chunk->setModifiedAt(y);
 
 	if (lx == CHUNK_W-1 && (chunk = getChunk(cx+ox+1, cz+oz))) 
-		chunk->setModified(true);
+		chunk->setModifiedAt(y);
 	if (lz == CHUNK_D-1 && (chunk = getChunk(cx+ox, cz+oz+1))) 
-		chunk->setModified(true);
+		chunk->setModifiedAt(y);
 }
 
 voxel* Chunks::rayCast(glm::vec3 start, 
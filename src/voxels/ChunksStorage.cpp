@@ -3,14 +3,12 @@
 #include <assert.h>
 #include <iostream>
 
-#include "VoxelsVolume.h"
 #include "Chunk.h"
 #include "Block.h"
 #include "../content/Content.h"
 #include "../files/WorldFiles.h"
 #include "../world/Level.h"
 #include "../world/World.h"
-#include "../maths/voxmaths.h"
 #include "../lighting/Lightmap.h"
 #include "../items/Inventories.h"
 #include "../typedefs.h"
@@ -64,7 +62,20 @@ std::shared_ptr<Chunk> ChunksStorage::create(int x, int z) {
 		for(auto& entry : chunk->inventories) {
 			level->inventories->store(entry.second);
 		}
-        verifyLoadedChunk(level->content->getIndices(), chunk.get());
+        auto indices = level->content->getIndices();
+        verifyLoadedChunk(indices, chunk.get());
+
+        std::unique_ptr<ubyte[]> heights(wfile->getHeights(chunk->x, chunk->z));
+        if (heights == nullptr || !chunk->heightmap.decode(heights.get())) {
+            chunk->heightmap.build(chunk->voxels, indices->getBlockDefs());
+        }
+
+        uint32_t size;
+        const ubyte* emitters = wfile->getEmitters(chunk->x, chunk->z, size);
+        if (emitters == nullptr || !chunk->emitters.decode(
+                emitters, size, chunk->voxels, indices->getBlockDefs())) {
+            chunk->emitters.build(chunk->voxels, indices->getBlockDefs());
+        }
 	}
 
 	std::unique_ptr<light_t[]> lights (wfile->getLights(chunk->x, chunk->z));
@@ -74,81 +85,3 @@ std::shared_ptr<Chunk> ChunksStorage::create(int x, int z) {
 	}
 	return chunk;
 }
-
-// some magic code
-void ChunksStorage::getVoxels(VoxelsVolume* volume, bool backlight) const {
-	const Content* content = level->content;
-	auto indices = content->getIndices();
-	voxel* voxels = volume->getVoxels();
-	light_t* lights = volume->getLights();
-	int x = volume->getX();
-	int y = volume->getY();
-	int z = volume->getZ();
-
-	int w = volume->getW();
-	int h = volume->getH();
-	int d = volume->getD();
-
-	int scx = floordiv(x, CHUNK_W);
-	int scz = floordiv(z, CHUNK_D);
-
-	int ecx = floordiv(x + w, CHUNK_W);
-	int ecz = floordiv(z + d, CHUNK_D);
-
-	int cw = ecx - scx + 1;
-	int ch = ecz - scz + 1;
-
-	// cw*ch chunks will be scanned
-	for (int cz = scz; cz < scz + ch; cz++) {
-		for (int cx = scx; cx < scx + cw; cx++) {
-			auto found = chunksMap.find(glm::ivec2(cx, cz));
-			if (found == chunksMap.end()) {
-				// no chunk loaded -> filling with BLOCK_VOID
-				for (int ly = y; ly < y + h; ly++) {
-					for (int lz = max(z, cz * CHUNK_D);
-						lz < min(z + d, (cz + 1) * CHUNK_D);
-						lz++) {
-						for (int lx = max(x, cx * CHUNK_W);
-							lx < min(x + w, (cx + 1) * CHUNK_W);
-							lx++) {
-							uint idx = vox_index(lx - x, ly - y, lz - z, w, d);
-							voxels[idx].id = BLOCK_VOID;
-							lights[idx] = 0;
-						}
-					}
-				}
-			} else {
-				auto& chunk = found->second;
-				const voxel* cvoxels = chunk->voxels;
-				const light_t* clights = chunk->lightmap.getLights();
-				for (int ly = y; ly < y + h; ly++) {
-					for (int lz = max(z, cz * CHUNK_D);
-						lz < min(z + d, (cz + 1) * CHUNK_D);
-						lz++) {
-						for (int lx = max(x, cx * CHUNK_W);
-							lx < min(x + w, (cx + 1) * CHUNK_W);
-							lx++) {
-							uint vidx = vox_index(lx - x, ly - y, lz - z, w, d);
-							uint cidx = vox_index(lx - cx * CHUNK_W, ly, 
-										lz - cz * CHUNK_D, CHUNK_W, CHUNK_D);
-							voxels[vidx] = cvoxels[cidx];
-							light_t light = clights[cidx];
-							if (backlight) {
-								const Block* block = indices->getBlockDef(voxels[vidx].id);
-								if (block->lightPassing) {
-									light = Lightmap::combine(
-										min(15, Lightmap::extract(light, 0)+1),
-										min(15, Lightmap::extract(light, 1)+1),
-										min(15, Lightmap::extract(light, 2)+1),
-										min(15, Lightmap::extract(light, 3))
-									);
-								}
-							}
-							lights[vidx] = light;
-						}
-					}
-				}
-			}
-		}
-	}
-}
@@ -0,0 +1,74 @@
+#include "Emitters.h"
+
+#include <algorithm>
+
+#include "voxel.h"
+#include "Block.h"
+#include "../util/data_io.h"
+
+void Emitters::build(const voxel* voxels, const Block* const* blockDefs) {
+	indices.clear();
+	for (uint i = 0; i < CHUNK_VOL; i++) {
+		if (blockDefs[voxels[i].id]->rt.emissive) {
+			indices.push_back(i);
+		}
+	}
+}
+
+void Emitters::update(uint index, bool emissive) {
+	auto found = std::find(indices.begin(), indices.end(), index);
+	if (emissive) {
+		if (found == indices.end()) {
+			indices.push_back(index);
+		}
+	} else if (found != indices.end()) {
+		*found = indices.back();
+		indices.pop_back();
+	}
+}
+
+/**
+  Emitters format:
+	- byte-order: big-endian
+
+	```cpp
+	int32_t count;
+	uint16_t indices[count];
+	```
+*/
+ubyte* Emitters::encode(size_t& size) const {
+	size = 4 + indices.size() * 2;
+	ubyte* buffer = new ubyte[size];
+	dataio::write_int32_big(indices.size(), buffer, 0);
+	for (size_t i = 0; i < indices.size(); i++) {
+		dataio::write_int16_big(indices[i], buffer, 4 + i * 2);
+	}
+	return buffer;
+}
+
+bool Emitters::decode(const ubyte* data, size_t size, 
+					  const voxel* voxels, const Block* const* blockDefs) {
+	if (size < 4) {
+		return false;
+	}
+	size_t count = dataio::read_int32_big(data, 0);
+	if (count > CHUNK_VOL || size != 4 + count * 2) {
+		return false;
+	}
+	indices.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		uint16_t index = dataio::read_int16_big(data, 4 + i * 2);
+		if (index >= CHUNK_VOL || !blockDefs[voxels[index].id]->rt.emissive) {
+			indices.clear();
+			return false;
+		}
+		indices[i] = index;
+	}
+	// order does not matter, sorted to find duplicates
+	std::sort(indices.begin(), indices.end());
+	if (std::adjacent_find(indices.begin(), indices.end()) != indices.end()) {
+		indices.clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,46 @@
+#ifndef VOXELS_EMITTERS_H_
+#define VOXELS_EMITTERS_H_
+
+#include <vector>
+
+#include "../constants.h"
+#include "../typedefs.h"
+
+struct voxel;
+class Block;
+
+static_assert(CHUNK_VOL <= 0x10000, "emitter indices must fit uint16_t");
+
+/* Voxel indices (see vox_index) of a chunk emissive blocks.
+   Used to seed lights without scanning whole chunk volume */
+class Emitters {
+	std::vector<uint16_t> indices;
+public:
+	inline const std::vector<uint16_t>& getIndices() const {
+		return indices;
+	}
+
+	/* Build index from scratch scanning all chunk voxels */
+	void build(const voxel* voxels, const Block* const* blockDefs);
+
+	/* Add emissive voxel index (used by world generator) */
+	inline void add(uint index) {
+		indices.push_back(index);
+	}
+
+	/* Update index after voxel has changed
+	   @param index voxel index
+	   @param emissive is the new block emissive */
+	void update(uint index, bool emissive);
+
+	ubyte* encode(size_t& size) const;
+
+	/* Only stored entries are checked, so the caller must not pass
+	   data stored with other content (see WorldFiles::layersStamp)
+	   @return true if data is valid and every index points to
+	   an emissive block once */
+	bool decode(const ubyte* data, size_t size, 
+				const voxel* voxels, const Block* const* blockDefs);
+};
+
+#endif // VOXELS_EMITTERS_H_
@@ -0,0 +1,119 @@
+#include "Heightmap.h"
+
+#include "voxel.h"
+#include "Block.h"
+
+static int scan_filled(const voxel* voxels, int x, int y, int z) {
+	for (; y >= 0; y--) {
+		if (voxels[vox_index(x, y, z)].id != BLOCK_AIR) {
+			return y + 1;
+		}
+	}
+	return 0;
+}
+
+static int scan_opaque(const voxel* voxels, const Block* const* blockDefs, 
+					   int x, int y, int z) {
+	for (; y >= 0; y--) {
+		if (!blockDefs[voxels[vox_index(x, y, z)].id]->skyLightPassing) {
+			return y + 1;
+		}
+	}
+	return 0;
+}
+
+void Heightmap::updateTop() {
+	int max = 0;
+	for (int i = 0; i < HEIGHTMAP_AREA; i++) {
+		if (filled[i] > max)
+			max = filled[i];
+	}
+	top = max;
+}
+
+void Heightmap::build(const voxel* voxels, const Block* const* blockDefs) {
+	for (int z = 0; z < CHUNK_D; z++) {
+		for (int x = 0; x < CHUNK_W; x++) {
+			int filledHeight = scan_filled(voxels, x, CHUNK_H-1, z);
+			// opaque block can't be higher than the highest non-air one
+			int opaqueHeight = scan_opaque(voxels, blockDefs, x, filledHeight-1, z);
+			set(x, z, opaqueHeight, filledHeight);
+		}
+	}
+	updateTop();
+}
+
+bool Heightmap::update(const voxel* voxels, const Block* const* blockDefs, 
+					   int x, int y, int z) {
+	const int index = z * CHUNK_W + x;
+	const voxel& vox = voxels[vox_index(x, y, z)];
+	const Block* def = blockDefs[vox.id];
+
+	int prevFilled = filled[index];
+	if (vox.id != BLOCK_AIR) {
+		if (y + 1 > filled[index])
+			filled[index] = y + 1;
+	} else if (y + 1 == filled[index]) {
+		filled[index] = scan_filled(voxels, x, y - 1, z);
+	}
+
+	if (!def->skyLightPassing) {
+		if (y + 1 > opaque[index])
+			opaque[index] = y + 1;
+	} else if (y + 1 == opaque[index]) {
+		opaque[index] = scan_opaque(voxels, blockDefs, x, y - 1, z);
+	}
+
+	if (filled[index] > top) {
+		top = filled[index];
+		return true;
+	} else if (prevFilled == top && filled[index] < top) {
+		updateTop();
+		return top != prevFilled;
+	}
+	return false;
+}
+
+void Heightmap::finish() {
+	updateTop();
+}
+
+/**
+  Heightmap format:
+	- byte-order: big-endian
+	- first and second bytes are separated for RLE efficiency
+
+	```cpp
+	uint8_t opaque_first_byte[HEIGHTMAP_AREA];
+	uint8_t opaque_second_byte[HEIGHTMAP_AREA];
+	uint8_t filled_first_byte[HEIGHTMAP_AREA];
+	uint8_t filled_second_byte[HEIGHTMAP_AREA];
+	```
+
+	Total size: (HEIGHTMAP_AREA * 4) bytes
+*/
+ubyte* Heightmap::encode() const {
+	ubyte* buffer = new ubyte[HEIGHTMAP_DATA_LEN];
+	for (int i = 0; i < HEIGHTMAP_AREA; i++) {
+		buffer[i] = opaque[i] >> 8;
+		buffer[HEIGHTMAP_AREA + i] = opaque[i] & 0xFF;
+		buffer[HEIGHTMAP_AREA*2 + i] = filled[i] >> 8;
+		buffer[HEIGHTMAP_AREA*3 + i] = filled[i] & 0xFF;
+	}
+	return buffer;
+}
+
+bool Heightmap::decode(const ubyte* data) {
+	for (int i = 0; i < HEIGHTMAP_AREA; i++) {
+		int opaqueHeight = (data[i] << 8) | data[HEIGHTMAP_AREA + i];
+		int filledHeight = (data[HEIGHTMAP_AREA*2 + i] << 8) | 
+							data[HEIGHTMAP_AREA*3 + i];
+		if (opaqueHeight > filledHeight || filledHeight > CHUNK_H) {
+			return false;
+		}
+		opaque[i] = opaqueHeight;
+		filled[i] = filledHeight;
+	}
+	updateTop();
+	return true;
+}
@@ -0,0 +1,63 @@
+#ifndef VOXELS_HEIGHTMAP_H_
+#define VOXELS_HEIGHTMAP_H_
+
+#include "../constants.h"
+#include "../typedefs.h"
+
+struct voxel;
+class Block;
+
+constexpr int HEIGHTMAP_AREA = CHUNK_W*CHUNK_D;
+constexpr int HEIGHTMAP_DATA_LEN = HEIGHTMAP_AREA*4;
+
+/* Per-column heights of a chunk.
+   Height is y of the highest matching block + 1 or 0 if column has no one.
+   Opaque block is a block that does not pass sky light. */
+class Heightmap {
+	uint16_t opaque[HEIGHTMAP_AREA] {};
+	uint16_t filled[HEIGHTMAP_AREA] {};
+	/* Max of filled heights */
+	int top = 0;
+
+	void updateTop();
+public:
+	/* @return height of the highest opaque block in column */
+	inline int getOpaque(int x, int z) const {
+		return opaque[z * CHUNK_W + x];
+	}
+
+	/* @return height of the highest non-air block in column */
+	inline int getFilled(int x, int z) const {
+		return filled[z * CHUNK_W + x];
+	}
+
+	/* @return height of the highest non-air block in chunk */
+	inline int getTop() const {
+		return top;
+	}
+
+	/* Build heightmap from scratch scanning columns down */
+	void build(const voxel* voxels, const Block* const* blockDefs);
+
+	/* Update column after voxel at x,y,z has changed
+	   @return true if chunk top has changed */
+	bool update(const voxel* voxels, const Block* const* blockDefs, 
+				int x, int y, int z);
+
+	/* Set column heights directly (used by world generator) */
+	inline void set(int x, int z, int opaqueHeight, int filledHeight) {
+		opaque[z * CHUNK_W + x] = opaqueHeight;
+		filled[z * CHUNK_W + x] = filledHeight;
+	}
+
+	/* Must be called after set(...) calls */
+	void finish();
+
+	ubyte* encode() const;
+	/* Heights are only range-checked, so the caller must not pass
+	   data stored with other content (see WorldFiles::layersStamp)
+	   @return true if all is fine */
+	bool decode(const ubyte* data);
+};
+
+#endif // VOXELS_HEIGHTMAP_H_
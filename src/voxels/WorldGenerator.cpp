@@ -2,6 +2,8 @@
 #include "voxel.h"
 #include "Chunk.h"
 #include "Block.h"
+#include "Heightmap.h"
+#include "Emitters.h"
 
 #include <iostream>
 #include <vector>
@@ -90,7 +92,8 @@ WorldGenerator::WorldGenerator(const Content* content)
                  idLeaves(content->requireBlock("base:leaves").rt.id),
                  idGrass(content->requireBlock("base:grass").rt.id),
                  idFlower(content->requireBlock("base:flower").rt.id),
-                 idBazalt(content->requireBlock("base:bazalt").rt.id) {}
+                 idBazalt(content->requireBlock("base:bazalt").rt.id),
+                 blockDefs(content->getIndices()->getBlockDefs()) {}
 
 int generate_tree(fnl_state *noise, 
                   PseudoRandom* random, 
@@ -131,7 +134,8 @@ int generate_tree(fnl_state *noise,
     return 0;
 }
 
-void WorldGenerator::generate(voxel* voxels, int cx, int cz, int seed){
+void WorldGenerator::generate(voxel* voxels, Heightmap& heightmap, Emitters& emitters, 
+                              int cx, int cz, int seed){
     const int treesTile = 12;
     fnl_state noise = fnlCreateState();
     noise.noise_type = FNL_NOISE_OPENSIMPLEX2;
@@ -170,6 +174,8 @@ void WorldGenerator::generate(voxel* voxels, int cx, int cz, int seed){
         for (int x = 0; x < CHUNK_W; x++){
             int cur_x = x + cx * CHUNK_W;
             float height = heights.get(MAPS::HEIGHT, cur_x, cur_z);
+            int opaqueHeight = 0;
+            int filledHeight = 0;
 
             for (int cur_y = 0; cur_y < CHUNK_H; cur_y++){
                 // int cur_y = y;
@@ -213,7 +219,16 @@ void WorldGenerator::generate(voxel* voxels, int cx, int cz, int seed){
                 }
                 voxels[(cur_y * CHUNK_D + z) * CHUNK_W + x].id = id;
                 voxels[(cur_y * CHUNK_D + z) * CHUNK_W + x].states = states;
+                if (id != BLOCK_AIR) {
+                    filledHeight = cur_y + 1;
+                    if (!blockDefs[id]->skyLightPassing)
+                        opaqueHeight = cur_y + 1;
+                    if (blockDefs[id]->rt.emissive)
+                        emitters.add((cur_y * CHUNK_D + z) * CHUNK_W + x);
+                }
             }
+            heightmap.set(x, z, opaqueHeight, filledHeight);
         }
     }
+    heightmap.finish();
 }
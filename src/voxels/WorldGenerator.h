@@ -4,7 +4,10 @@
 #include "../typedefs.h"
 
 struct voxel;
+class Block;
 class Content;
+class Heightmap;
+class Emitters;
 
 class WorldGenerator {
 	blockid_t const idStone;
@@ -17,9 +20,12 @@ class WorldGenerator {
 	blockid_t const idGrass;
 	blockid_t const idFlower;
 	blockid_t const idBazalt;
+	const Block* const* const blockDefs;
 public:
 	WorldGenerator(const Content* content);
-	void generate(voxel* voxels, int x, int z, int seed);
+	/* Generate chunk voxels filling its heightmap and emitters on the way */
+	void generate(voxel* voxels, Heightmap& heightmap, Emitters& emitters, 
+				  int x, int z, int seed);
 };
 
 #endif /* VOXELS_WORLDGENERATOR_H_ */
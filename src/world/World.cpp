@@ -32,6 +32,7 @@ World::World(
       content(content),
       packs(packs) {
     wfile = new WorldFiles(directory, settings.debug);
+    wfile->layersStamp = content->getIndices()->getLayersStamp();
 }
 
 World::~World(){